@@ -0,0 +1,116 @@
+/*
+Copyright Niels Dekker, LKEB, Leiden University Medical Center
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0.txt
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "noexcept_benchmark.h"
+#include "arrays_of_objects.h"
+
+#include <array>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+  // Like the object_class of stack_unwinding_array_test.cpp, but its
+  // constructor is noexcept in the noexcept lib, while its destructor is
+  // potentially-throwing in the implicit lib.
+  class array_element
+  {
+    static unsigned m_object_counter;
+  public:
+    array_element() OPTIONAL_EXCEPTION_SPECIFIER
+    {
+      ++m_object_counter;
+      // The compiler cannot assume that this bool is always false, even though it is!
+      bool do_throw_exception = false;
+      noexcept_benchmark::do_not_optimize(do_throw_exception);
+      noexcept_benchmark::throw_exception_if(do_throw_exception);
+    }
+
+    ~array_element() noexcept(SPECIFY_NOEXCEPT != 0)
+    {
+      --m_object_counter;
+    }
+
+    static unsigned get_object_counter()
+    {
+      return m_object_counter;
+    }
+  };
+
+
+  unsigned array_element::m_object_counter;
+
+
+  // Constructs and destructs a std::array, like the C arrays of
+  // stack_unwinding_array_test.cpp.
+  struct std_array
+  {
+    template <unsigned array_size>
+    static void run() OPTIONAL_EXCEPTION_SPECIFIER
+    {
+      const std::array<array_element, array_size> elements;
+      (void)elements;
+    }
+  };
+
+
+  template <typename T>
+  double profile_array_construction(T construct_and_destruct)
+  {
+    return noexcept_benchmark::profile_func_call([construct_and_destruct]
+    {
+      NOEXCEPT_BENCHMARK_TRY
+      {
+        construct_and_destruct();
+      }
+      NOEXCEPT_BENCHMARK_CATCH(const std::exception&)
+      {
+        // Should never occur!
+        std::cerr << "Error! object_counter = " << array_element::get_object_counter() << '\n';
+      }
+    });
+  }
+}
+
+
+NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT
+double LIB_NAME::test_array_new(const unsigned number_of_objects)
+{
+  return profile_array_construction([number_of_objects]
+  {
+    delete[] new array_element[number_of_objects];
+  });
+}
+
+
+NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT
+double LIB_NAME::test_vector_construction(const unsigned number_of_objects)
+{
+  return profile_array_construction([number_of_objects]
+  {
+    const std::vector<array_element> elements(number_of_objects);
+  });
+}
+
+
+NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT
+double LIB_NAME::test_std_array(const unsigned number_of_objects)
+{
+  return profile_array_construction([number_of_objects]
+  {
+    construct_and_destruct_arrays<std_array>(number_of_objects);
+  });
+}
@@ -0,0 +1,51 @@
+#ifndef noexcept_benchmark_arrays_of_objects_h
+#define noexcept_benchmark_arrays_of_objects_h
+
+/*
+Copyright Niels Dekker, LKEB, Leiden University Medical Center
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0.txt
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "noexcept_benchmark.h"
+
+namespace
+{
+  // Constructs and destructs N objects, in arrays of the largest supported
+  // array size (a power of ten) that is not larger than N, and in smaller
+  // arrays for the remaining objects. ArrayFunc::run<array_size>() should
+  // construct and destruct a single array of the specified size. Does not
+  // construct any object when N is zero.
+  template <typename ArrayFunc, unsigned array_size = NOEXCEPT_BENCHMARK_MAX_STACK_UNWINDING_OBJECTS>
+  void construct_and_destruct_arrays(const unsigned N) OPTIONAL_EXCEPTION_SPECIFIER
+  {
+    if (N == 0)
+    {
+      return;
+    }
+    const unsigned number_of_arrays = N / array_size;
+
+    for (unsigned i = 0; i < number_of_arrays; ++i)
+    {
+      ArrayFunc::template run<array_size>();
+    }
+
+    // The remaining objects are constructed in smaller arrays.
+    if (array_size > 1)
+    {
+      construct_and_destruct_arrays<ArrayFunc, (array_size >= 10) ? (array_size / 10) : 1>(N % array_size);
+    }
+  }
+}
+
+#endif
@@ -28,18 +28,19 @@ namespace
 
   void catching_recursive_func(unsigned short number_of_func_calls) OPTIONAL_EXCEPTION_SPECIFIER
   {
-    try
+    NOEXCEPT_BENCHMARK_TRY
     {
       // The compiler cannot assume that this bool is always false, even though it is!
-      volatile bool volatile_false = noexcept_benchmark::get_false();
+      bool do_throw_exception = false;
+      noexcept_benchmark::do_not_optimize(do_throw_exception);
 
       if (--number_of_func_calls > 0)
       {
-        func(volatile_false);
+        func(do_throw_exception);
         catching_recursive_func(number_of_func_calls);
       }
     }
-    catch (const std::exception&)
+    NOEXCEPT_BENCHMARK_CATCH(const std::exception&)
     {
       // Should never occur!
       std::cerr
@@ -51,15 +52,17 @@ namespace
 
 
 NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT
-double LIB_NAME::catching_func()
+double LIB_NAME::catching_func(const unsigned number_of_func_calls)
 {
-  return noexcept_benchmark::profile_func_call([]
+  assert(number_of_func_calls <= USHRT_MAX);
+
+  return noexcept_benchmark::profile_func_call([number_of_func_calls]
   {
-    try
+    NOEXCEPT_BENCHMARK_TRY
     {
-      catching_recursive_func(NOEXCEPT_BENCHMARK_NUMBER_OF_CATCHING_RECURSIVE_FUNC_CALLS);
+      catching_recursive_func(static_cast<unsigned short>(number_of_func_calls));
     }
-    catch (const std::exception&)
+    NOEXCEPT_BENCHMARK_CATCH(const std::exception&)
     {
       // Should never occur!
       std::cerr
@@ -0,0 +1,264 @@
+/*
+Copyright Niels Dekker, LKEB, Leiden University Medical Center
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0.txt
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Container operations that may either move or copy their elements,
+// depending on whether the element type has noexcept move operations
+// (std::move_if_noexcept). N is the number of elements. The std::deque
+// insert is included for comparison, as it always moves its elements. Each
+// timed operation ends with clobber_memory(), so that the compiler cannot
+// optimize away its stores, or move them out of the timed code.
+
+#include "noexcept_benchmark.h"
+#include "my_string.h"
+
+#include <deque>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if NOEXCEPT_BENCHMARK_HAS_CXX17_TEST_CASES
+#  include <optional>
+#  include <variant>
+#endif
+
+namespace
+{
+  // Appends N elements, one by one, starting with an empty container.
+  template <typename Container>
+  double profile_push_back(const unsigned number_of_elements)
+  {
+    Container container;
+
+    return noexcept_benchmark::profile_func_call([&container, number_of_elements]
+    {
+      for (unsigned i = 0; i < number_of_elements; ++i)
+      {
+        container.emplace_back(1);
+      }
+      noexcept_benchmark::clobber_memory();
+    });
+  }
+
+
+  // Inserts a single element in the middle of a container of N elements,
+  // which has no spare capacity.
+  template <typename Container>
+  double profile_insert(const unsigned number_of_elements)
+  {
+    using value_type = typename Container::value_type;
+
+    Container container(number_of_elements, value_type(1));
+    container.shrink_to_fit();
+
+    return noexcept_benchmark::profile_func_call([&container, number_of_elements]
+    {
+      container.insert(container.begin() + number_of_elements / 2, value_type(1));
+      noexcept_benchmark::clobber_memory();
+    });
+  }
+
+
+  // Resizes a container of N elements, which has no spare capacity, to N + 1.
+  template <typename Container>
+  double profile_resize(const unsigned number_of_elements)
+  {
+    using value_type = typename Container::value_type;
+
+    Container container(number_of_elements, value_type(1));
+    container.shrink_to_fit();
+
+    return noexcept_benchmark::profile_func_call([&container, number_of_elements]
+    {
+      container.resize(number_of_elements + 1);
+      noexcept_benchmark::clobber_memory();
+    });
+  }
+
+
+  // Shrinks a container of N elements, after it has grown by adding its last element.
+  template <typename Container>
+  double profile_shrink_to_fit(const unsigned number_of_elements)
+  {
+    using value_type = typename Container::value_type;
+
+    Container container(number_of_elements - 1, value_type(1));
+    container.shrink_to_fit();
+    container.push_back(value_type(1));
+
+    return noexcept_benchmark::profile_func_call([&container]
+    {
+      container.shrink_to_fit();
+      noexcept_benchmark::clobber_memory();
+    });
+  }
+
+
+  // Note: libstdc++ caches the hash codes when the hash function is not
+  // noexcept, so that a rehash does not need to call the hash function.
+  struct unsigned_hash
+  {
+    std::size_t operator()(const unsigned key) const OPTIONAL_EXCEPTION_SPECIFIER
+    {
+      return key;
+    }
+  };
+
+
+  // Doubles the number of buckets of an unordered map of N elements.
+  template <typename Map>
+  double profile_rehash(const unsigned number_of_elements)
+  {
+    using mapped_type = typename Map::mapped_type;
+
+    Map map;
+
+    for (unsigned i = 0; i < number_of_elements; ++i)
+    {
+      map.emplace(i, mapped_type(1));
+    }
+
+    return noexcept_benchmark::profile_func_call([&map]
+    {
+      map.rehash(2 * map.bucket_count());
+      noexcept_benchmark::clobber_memory();
+    });
+  }
+
+
+  // Move-assigns each of N engaged objects (like std::optional objects) from
+  // another engaged object, which move-assigns their elements.
+  template <typename T, typename Element>
+  double profile_move_assign(const unsigned number_of_elements)
+  {
+    std::vector<T> objects;
+    std::vector<T> sources;
+    objects.reserve(number_of_elements);
+    sources.reserve(number_of_elements);
+
+    for (unsigned i = 0; i < number_of_elements; ++i)
+    {
+      objects.emplace_back(Element(1));
+      sources.emplace_back(Element(1));
+    }
+
+    return noexcept_benchmark::profile_func_call([&objects, &sources]
+    {
+      for (std::size_t i = 0; i < objects.size(); ++i)
+      {
+        objects[i] = std::move(sources[i]);
+      }
+      noexcept_benchmark::clobber_memory();
+    });
+  }
+
+
+  // Assigns an element to each of N objects that hold another type. The class
+  // std::variant decides how to assign, based on whether the element type is
+  // nothrow move constructible: if so, it makes a temporary copy and moves it
+  // into the variant.
+  template <typename T, typename Element>
+  double profile_assign(const unsigned number_of_elements)
+  {
+    std::vector<T> objects(number_of_elements);
+    const Element element(1);
+
+    return noexcept_benchmark::profile_func_call([&objects, &element]
+    {
+      for (T& object : objects)
+      {
+        object = element;
+      }
+      noexcept_benchmark::clobber_memory();
+    });
+  }
+
+}
+
+
+NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT
+double LIB_NAME::test_vector_push_back(const unsigned number_of_elements)
+{
+  return profile_push_back<std::vector<my_string>>(number_of_elements);
+}
+
+
+NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT
+double LIB_NAME::test_vector_push_back_arena(const unsigned number_of_elements)
+{
+  const double duration = profile_push_back<std::vector<my_arena_string>>(number_of_elements);
+  arena_allocation::release();
+  return duration;
+}
+
+
+NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT
+double LIB_NAME::test_vector_push_back_sso(const unsigned number_of_elements)
+{
+  return profile_push_back<std::vector<my_sso_string>>(number_of_elements);
+}
+
+
+NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT
+double LIB_NAME::test_vector_insert(const unsigned number_of_elements)
+{
+  return profile_insert<std::vector<my_string>>(number_of_elements);
+}
+
+
+NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT
+double LIB_NAME::test_vector_resize(const unsigned number_of_elements)
+{
+  return profile_resize<std::vector<my_string>>(number_of_elements);
+}
+
+
+NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT
+double LIB_NAME::test_vector_shrink_to_fit(const unsigned number_of_elements)
+{
+  return profile_shrink_to_fit<std::vector<my_string>>(number_of_elements);
+}
+
+
+NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT
+double LIB_NAME::test_deque_insert(const unsigned number_of_elements)
+{
+  return profile_insert<std::deque<my_string>>(number_of_elements);
+}
+
+
+NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT
+double LIB_NAME::test_unordered_map_rehash(const unsigned number_of_elements)
+{
+  return profile_rehash<std::unordered_map<unsigned, my_string, unsigned_hash>>(number_of_elements);
+}
+
+
+#if NOEXCEPT_BENCHMARK_HAS_CXX17_TEST_CASES
+
+NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT
+double LIB_NAME::test_optional_assign(const unsigned number_of_elements)
+{
+  return profile_move_assign<std::optional<my_string>, my_string>(number_of_elements);
+}
+
+
+NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT
+double LIB_NAME::test_variant_assign(const unsigned number_of_elements)
+{
+  return profile_assign<std::variant<int, my_string>, my_string>(number_of_elements);
+}
+
+#endif
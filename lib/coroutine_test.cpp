@@ -0,0 +1,169 @@
+/*
+Copyright Niels Dekker, LKEB, Leiden University Medical Center
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0.txt
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "noexcept_benchmark.h"
+
+#if NOEXCEPT_BENCHMARK_HAS_COROUTINE_TEST_CASES
+
+#include <coroutine>
+#include <exception>
+
+namespace
+{
+  void coroutine_func(const bool do_throw_exception) OPTIONAL_EXCEPTION_SPECIFIER
+  {
+    noexcept_benchmark::throw_exception_if(do_throw_exception);
+  }
+
+
+  // Always suspends, like std::suspend_always, but with an optional exception specification.
+  struct suspend_awaiter
+  {
+    bool await_ready() const OPTIONAL_EXCEPTION_SPECIFIER
+    {
+      return false;
+    }
+
+    void await_suspend(std::coroutine_handle<>) const OPTIONAL_EXCEPTION_SPECIFIER
+    {
+    }
+
+    void await_resume() const OPTIONAL_EXCEPTION_SPECIFIER
+    {
+    }
+  };
+
+
+  // The return type of a coroutine that starts suspended, is resumed by its
+  // caller, and is destroyed by the destructor.
+  class resumable
+  {
+  public:
+    struct promise_type
+    {
+      resumable get_return_object() OPTIONAL_EXCEPTION_SPECIFIER
+      {
+        return resumable{ std::coroutine_handle<promise_type>::from_promise(*this) };
+      }
+
+      suspend_awaiter initial_suspend() OPTIONAL_EXCEPTION_SPECIFIER
+      {
+        return {};
+      }
+
+      // Note that final_suspend must be noexcept for both libs.
+      std::suspend_always final_suspend() noexcept
+      {
+        return {};
+      }
+
+      suspend_awaiter yield_value(unsigned) OPTIONAL_EXCEPTION_SPECIFIER
+      {
+        return {};
+      }
+
+      void return_void() OPTIONAL_EXCEPTION_SPECIFIER
+      {
+      }
+
+      void unhandled_exception() OPTIONAL_EXCEPTION_SPECIFIER
+      {
+#if SPECIFY_NOEXCEPT
+        std::terminate();
+#else
+        NOEXCEPT_BENCHMARK_RETHROW;
+#endif
+      }
+    };
+
+    explicit resumable(const std::coroutine_handle<promise_type> handle) noexcept
+      :
+      m_handle{ handle }
+    {
+    }
+
+    ~resumable()
+    {
+      m_handle.destroy();
+    }
+
+    resumable(const resumable&) = delete;
+    resumable& operator=(const resumable&) = delete;
+
+    void resume() const
+    {
+      m_handle.resume();
+    }
+
+  private:
+    const std::coroutine_handle<promise_type> m_handle;
+  };
+
+
+  resumable suspending_coroutine()
+  {
+    bool do_throw_exception = false;
+
+    for (unsigned i = 0;; ++i)
+    {
+      // The compiler cannot assume that this bool is still false, even though it is!
+      noexcept_benchmark::do_not_optimize(do_throw_exception);
+      coroutine_func(do_throw_exception);
+      co_yield i;
+    }
+  }
+
+
+  resumable one_shot_coroutine()
+  {
+    // The compiler cannot assume that this bool is always false, even though it is!
+    bool do_throw_exception = false;
+    noexcept_benchmark::do_not_optimize(do_throw_exception);
+    coroutine_func(do_throw_exception);
+    co_return;
+  }
+}
+
+
+NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT
+double LIB_NAME::test_coroutine_resume(const unsigned number_of_resumptions)
+{
+  return noexcept_benchmark::profile_func_call([number_of_resumptions]
+  {
+    const resumable coroutine = suspending_coroutine();
+
+    for (unsigned i = 0; i < number_of_resumptions; ++i)
+    {
+      coroutine.resume();
+    }
+  });
+}
+
+
+NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT
+double LIB_NAME::test_coroutine_frame(const unsigned number_of_coroutines)
+{
+  return noexcept_benchmark::profile_func_call([number_of_coroutines]
+  {
+    for (unsigned i = 0; i < number_of_coroutines; ++i)
+    {
+      const resumable coroutine = one_shot_coroutine();
+      coroutine.resume();
+    }
+  });
+}
+
+#endif
@@ -29,27 +29,26 @@ namespace
 
 
 NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT
-double LIB_NAME::test_inc_and_dec()
+double LIB_NAME::test_inc_and_dec(const unsigned number_of_func_calls)
 {
-  return noexcept_benchmark::profile_func_call([]
+  return noexcept_benchmark::profile_func_call([number_of_func_calls]
   {
-    const int number_of_func_calls = NOEXCEPT_BENCHMARK_INC_AND_DEC_FUNC_CALLS;
     int value = 0;
 
-    // The compiler cannot assume that this bool is always false, even though it is!
-    volatile bool volatile_false = noexcept_benchmark::get_false();
+    bool do_throw_exception = false;
 
-    try
+    NOEXCEPT_BENCHMARK_TRY
     {
-      for (int i = 0; i < number_of_func_calls; ++i)
+      for (unsigned i = 0; i < number_of_func_calls; ++i)
       {
-        const bool do_throw_exception = volatile_false;
+        // The compiler cannot assume that this bool is still false, even though it is!
+        noexcept_benchmark::do_not_optimize(do_throw_exception);
         ++value;
         func(do_throw_exception);
         --value;
       }
     }
-    catch (const std::exception&)
+    NOEXCEPT_BENCHMARK_CATCH(const std::exception&)
     {
     }
     if (value != 0)
@@ -26,15 +26,17 @@ namespace
 
 
 NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT
-double LIB_NAME::test_inline_func()
+double LIB_NAME::test_inline_func(const unsigned number_of_func_calls)
 {
-  enum { number_of_func_calls = NOEXCEPT_BENCHMARK_NUMBER_OF_INLINE_FUNC_CALLS };
-
-  return noexcept_benchmark::profile_func_call([]
+  return noexcept_benchmark::profile_func_call([number_of_func_calls]
   {
-    for (int i = 0; i < number_of_func_calls; ++i)
+    bool do_throw_exception = false;
+
+    for (unsigned i = 0; i < number_of_func_calls; ++i)
     {
-      inline_func(false);
+      // The compiler cannot assume that this bool is still false, even though it is!
+      noexcept_benchmark::do_not_optimize(do_throw_exception);
+      inline_func(do_throw_exception);
     }
   });
 }
@@ -26,13 +26,164 @@ limitations under the License.
 
 
 
+#ifndef NOEXCEPT_BENCHMARK_LIB_TEST_CASES
+// The sizes of the elements of the vector_reserve and vector_relocate test
+// cases, as checked by static_assert in lib/my_string.h.
+#  define NOEXCEPT_BENCHMARK_SIZEOF_MY_STRING sizeof(char*)
+#  define NOEXCEPT_BENCHMARK_SIZEOF_MY_SSO_STRING (16 + sizeof(char*))
+
+// The test cases that need C++17 (std::optional and std::variant).
+#  if NOEXCEPT_BENCHMARK_HAS_CXX17_TEST_CASES
+#    define NOEXCEPT_BENCHMARK_CXX17_LIB_TEST_CASES(X) \
+  X(test_optional_assign, "std::optional<my_string> move assignment", \
+    1, NOEXCEPT_BENCHMARK_NUMBER_OF_CONTAINER_ELEMENTS, INT_MAX, 0, 0) \
+  X(test_variant_assign, "std::variant<int, my_string> assignment", \
+    1, NOEXCEPT_BENCHMARK_NUMBER_OF_CONTAINER_ELEMENTS, INT_MAX, 0, 0)
+#  else
+#    define NOEXCEPT_BENCHMARK_CXX17_LIB_TEST_CASES(X)
+#  endif
+
+// The test cases that need C++20 coroutines.
+#  if NOEXCEPT_BENCHMARK_HAS_COROUTINE_TEST_CASES
+#    define NOEXCEPT_BENCHMARK_COROUTINE_LIB_TEST_CASES(X) \
+  X(test_coroutine_resume, "coroutine resume and suspend", \
+    1, NOEXCEPT_BENCHMARK_NUMBER_OF_EXPORTED_FUNC_CALLS, INT_MAX, 0, 1) \
+  X(test_coroutine_frame, "coroutine frame creation, resume and destruction", \
+    1, NOEXCEPT_BENCHMARK_NUMBER_OF_CONTAINER_ELEMENTS, INT_MAX, 0, 1)
+#  else
+#    define NOEXCEPT_BENCHMARK_COROUTINE_LIB_TEST_CASES(X)
+#  endif
+
+// The test cases that need std::move_only_function (C++23).
+#  if NOEXCEPT_BENCHMARK_HAS_MOVE_ONLY_FUNCTION_TEST_CASES
+#    define NOEXCEPT_BENCHMARK_MOVE_ONLY_FUNCTION_LIB_TEST_CASES(X) \
+  X(test_move_only_function_call, "std::move_only_function calls", \
+    1, NOEXCEPT_BENCHMARK_NUMBER_OF_EXPORTED_FUNC_CALLS, INT_MAX, 0, 1)
+#  else
+#    define NOEXCEPT_BENCHMARK_MOVE_ONLY_FUNCTION_LIB_TEST_CASES(X)
+#  endif
+
+// The test cases that need the parallel algorithms of C++17.
+#  if NOEXCEPT_BENCHMARK_HAS_EXECUTION_POLICY_TEST_CASES
+#    define NOEXCEPT_BENCHMARK_EXECUTION_POLICY_LIB_TEST_CASES(X) \
+  X(test_vector_relocate_par, "std::vector<my_string> relocation by std::execution::par", \
+    1, NOEXCEPT_BENCHMARK_INITIAL_VECTOR_SIZE, INT_MAX, NOEXCEPT_BENCHMARK_SIZEOF_MY_STRING, 0)
+#  else
+#    define NOEXCEPT_BENCHMARK_EXECUTION_POLICY_LIB_TEST_CASES(X)
+#  endif
+
+// The test cases that really throw, which are left out when exceptions are
+// disabled (-fno-exceptions).
+#  if NOEXCEPT_BENCHMARK_HAS_EXCEPTIONS
+#    define NOEXCEPT_BENCHMARK_THROWING_LIB_TEST_CASES(X) \
+  X(test_throw_path_propagate, "throw, propagated through all frames", \
+    1, NOEXCEPT_BENCHMARK_THROW_PATH_FRAMES, INT_MAX, 0, 1) \
+  X(test_throw_path_catch_directly, "throw, caught directly in the innermost frame", \
+    1, NOEXCEPT_BENCHMARK_THROW_PATH_FRAMES, INT_MAX, 0, 1)
+#  else
+#    define NOEXCEPT_BENCHMARK_THROWING_LIB_TEST_CASES(X)
+#  endif
+
+// The test cases exported by each lib, in order: X(func, description, min_N, default_N, max_N, bytes_per_N, is_N_calls)
+// A new lib/*_test.cpp only needs to define its function and add it here.
+// Calibration (--calibrate) may choose any N from [min_N, max_N]. When
+// bytes_per_N is not zero, the throughput is also reported, in GB/s.
+// is_N_calls is 1 when N is a number of calls (or frames), rather than a
+// number of elements, which is checked to take at least a CPU cycle each.
+#  define NOEXCEPT_BENCHMARK_LIB_TEST_CASES(X) \
+  X(test_inline_func, "inline function calls", \
+    1, NOEXCEPT_BENCHMARK_NUMBER_OF_INLINE_FUNC_CALLS, INT_MAX, 0, 1) \
+  X(test_std_function_call, "std::function calls", \
+    1, NOEXCEPT_BENCHMARK_NUMBER_OF_EXPORTED_FUNC_CALLS, INT_MAX, 0, 1) \
+  NOEXCEPT_BENCHMARK_MOVE_ONLY_FUNCTION_LIB_TEST_CASES(X) \
+  NOEXCEPT_BENCHMARK_COROUTINE_LIB_TEST_CASES(X) \
+  X(catching_func, "catching function calls", \
+    1, NOEXCEPT_BENCHMARK_NUMBER_OF_CATCHING_RECURSIVE_FUNC_CALLS, NOEXCEPT_BENCHMARK_NUMBER_OF_CATCHING_RECURSIVE_FUNC_CALLS, 0, 1) \
+  X(test_inc_and_dec, "inc `++` and dec `--`", \
+    1, NOEXCEPT_BENCHMARK_INC_AND_DEC_FUNC_CALLS, INT_MAX, 0, 1) \
+  X(test_simd_transform_float, "simd transform of float elements, by a func call per element", \
+    1, NOEXCEPT_BENCHMARK_NUMBER_OF_SIMD_ELEMENTS, NOEXCEPT_BENCHMARK_MAX_SIMD_ELEMENTS, 2 * sizeof(float), 0) \
+  X(test_simd_transform_int, "simd transform of int elements, by a func call per element", \
+    1, NOEXCEPT_BENCHMARK_NUMBER_OF_SIMD_ELEMENTS, NOEXCEPT_BENCHMARK_MAX_SIMD_ELEMENTS, 2 * sizeof(int), 0) \
+  X(test_simd_reduce_float, "simd reduction (sum) of float elements, by a func call per element", \
+    1, NOEXCEPT_BENCHMARK_NUMBER_OF_SIMD_ELEMENTS, NOEXCEPT_BENCHMARK_MAX_SIMD_ELEMENTS, sizeof(float), 0) \
+  X(test_simd_reduce_int, "simd reduction (sum) of int elements, by a func call per element", \
+    1, NOEXCEPT_BENCHMARK_NUMBER_OF_SIMD_ELEMENTS, NOEXCEPT_BENCHMARK_MAX_SIMD_ELEMENTS, sizeof(int), 0) \
+  X(test_simd_stencil_float, "simd three-point stencil of float elements, by a func call per element", \
+    3, NOEXCEPT_BENCHMARK_NUMBER_OF_SIMD_ELEMENTS, NOEXCEPT_BENCHMARK_MAX_SIMD_ELEMENTS, 2 * sizeof(float), 0) \
+  X(test_simd_stencil_int, "simd three-point stencil of int elements, by a func call per element", \
+    3, NOEXCEPT_BENCHMARK_NUMBER_OF_SIMD_ELEMENTS, NOEXCEPT_BENCHMARK_MAX_SIMD_ELEMENTS, 2 * sizeof(int), 0) \
+  X(test_stack_unwinding, "recursive stack unwinding", \
+    1, NOEXCEPT_BENCHMARK_STACK_UNWINDING_FUNC_CALLS, NOEXCEPT_BENCHMARK_MAX_STACK_UNWINDING_FUNC_CALLS, 0, 1) \
+  X(test_stack_unwinding_array, "stack unwinding array", \
+    1, NOEXCEPT_BENCHMARK_STACK_UNWINDING_OBJECTS, NOEXCEPT_BENCHMARK_MAX_STACK_UNWINDING_OBJECTS, 0, 0) \
+  X(test_std_array, "std::array construction", \
+    1, NOEXCEPT_BENCHMARK_STACK_UNWINDING_OBJECTS, NOEXCEPT_BENCHMARK_MAX_STACK_UNWINDING_OBJECTS, 0, 0) \
+  X(test_array_new, "array new[] and delete[]", \
+    1, NOEXCEPT_BENCHMARK_STACK_UNWINDING_OBJECTS, NOEXCEPT_BENCHMARK_MAX_STACK_UNWINDING_OBJECTS, 0, 0) \
+  X(test_vector_construction, "std::vector(N) construction", \
+    1, NOEXCEPT_BENCHMARK_STACK_UNWINDING_OBJECTS, NOEXCEPT_BENCHMARK_MAX_STACK_UNWINDING_OBJECTS, 0, 0) \
+  X(test_vector_reserve, "std::vector<my_string> reserve", \
+    1, NOEXCEPT_BENCHMARK_INITIAL_VECTOR_SIZE, INT_MAX, NOEXCEPT_BENCHMARK_SIZEOF_MY_STRING, 0) \
+  X(test_vector_reserve_arena, "std::vector<my_arena_string> reserve", \
+    1, NOEXCEPT_BENCHMARK_INITIAL_VECTOR_SIZE, INT_MAX, NOEXCEPT_BENCHMARK_SIZEOF_MY_STRING, 0) \
+  X(test_vector_reserve_sso, "std::vector<my_sso_string> reserve", \
+    1, NOEXCEPT_BENCHMARK_INITIAL_VECTOR_SIZE, INT_MAX, NOEXCEPT_BENCHMARK_SIZEOF_MY_SSO_STRING, 0) \
+  X(test_vector_reserve_relocatable, "relocating_vector<my_string> reserve, by memcpy", \
+    1, NOEXCEPT_BENCHMARK_INITIAL_VECTOR_SIZE, INT_MAX, NOEXCEPT_BENCHMARK_SIZEOF_MY_STRING, 0) \
+  X(test_vector_relocate, "std::vector<my_string> relocation", \
+    1, NOEXCEPT_BENCHMARK_INITIAL_VECTOR_SIZE, INT_MAX, NOEXCEPT_BENCHMARK_SIZEOF_MY_STRING, 0) \
+  NOEXCEPT_BENCHMARK_EXECUTION_POLICY_LIB_TEST_CASES(X) \
+  X(test_vector_push_back, "std::vector<my_string> push_back growth", \
+    1, NOEXCEPT_BENCHMARK_NUMBER_OF_CONTAINER_ELEMENTS, INT_MAX, 0, 0) \
+  X(test_vector_push_back_arena, "std::vector<my_arena_string> push_back growth", \
+    1, NOEXCEPT_BENCHMARK_NUMBER_OF_CONTAINER_ELEMENTS, INT_MAX, 0, 0) \
+  X(test_vector_push_back_sso, "std::vector<my_sso_string> push_back growth", \
+    1, NOEXCEPT_BENCHMARK_NUMBER_OF_CONTAINER_ELEMENTS, INT_MAX, 0, 0) \
+  X(test_vector_insert, "std::vector<my_string> insert in the middle", \
+    1, NOEXCEPT_BENCHMARK_NUMBER_OF_CONTAINER_ELEMENTS, INT_MAX, 0, 0) \
+  X(test_vector_resize, "std::vector<my_string> resize", \
+    1, NOEXCEPT_BENCHMARK_NUMBER_OF_CONTAINER_ELEMENTS, INT_MAX, 0, 0) \
+  X(test_vector_shrink_to_fit, "std::vector<my_string> shrink_to_fit", \
+    1, NOEXCEPT_BENCHMARK_NUMBER_OF_CONTAINER_ELEMENTS, INT_MAX, 0, 0) \
+  X(test_deque_insert, "std::deque<my_string> insert in the middle", \
+    1, NOEXCEPT_BENCHMARK_NUMBER_OF_CONTAINER_ELEMENTS, INT_MAX, 0, 0) \
+  X(test_unordered_map_rehash, "std::unordered_map<unsigned, my_string> rehash", \
+    1, NOEXCEPT_BENCHMARK_NUMBER_OF_CONTAINER_ELEMENTS, INT_MAX, 0, 0) \
+  NOEXCEPT_BENCHMARK_CXX17_LIB_TEST_CASES(X) \
+  NOEXCEPT_BENCHMARK_THROWING_LIB_TEST_CASES(X) \
+  X(test_throw_path_error_code, "error code, returned through all frames", \
+    1, NOEXCEPT_BENCHMARK_THROW_PATH_FRAMES, INT_MAX, 0, 1)
+#endif
+
+#define NOEXCEPT_BENCHMARK_DECLARE_TEST_CASE(func, description, min_N, default_N, max_N, bytes_per_N, is_N_calls) \
+    NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT double func(unsigned N);
+
 namespace NOEXCEPT_BENCHMARK_LIB_NAME
 {
     NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT void exported_func(bool do_throw_exception) NOEXCEPT_BENCHMARK_EXCEPTION_SPECIFIER;
-    NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT double catching_func();
-    NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT double test_inc_and_dec();
-    NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT double test_inline_func();
-    NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT double test_stack_unwinding();
-    NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT double test_stack_unwinding_array();
-    NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT double test_vector_reserve();
+    NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT void set_sample_hooks(const noexcept_benchmark::sample_hooks*);
+
+    // The calibration of the default timer of the executable (NOEXCEPT_BENCHMARK_TIMER), as estimated by
+    // the executable. A lib that uses another timer estimates the calibration of its own timer instead.
+    NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT void set_timer_calibration(
+      const char* timer_name, double seconds_per_tick, unsigned is_counter_available);
+
+    // The test cases of the lib, terminated by { nullptr, nullptr }.
+    NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT const noexcept_benchmark::lib_test_case* get_test_cases();
+
+    // For the throw_path tests. N is their total number of frames.
+    NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT void set_throw_path_parameters(
+      unsigned depth, unsigned locals_per_frame, unsigned exception_size);
+
+    // For vector_reserve: a noexcept_benchmark::huge_page_mode, a noexcept_benchmark::numa_placement,
+    // and whether to pre-fault the pages.
+    NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT void set_memory_placement(
+      unsigned huge_pages, unsigned numa, unsigned prefault);
+
+    // For --audit: the copy and move operations of standard operations on N elements, terminated by { nullptr }.
+    NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT const noexcept_benchmark::move_audit_entry* get_move_audit(unsigned N);
+    NOEXCEPT_BENCHMARK_LIB_TEST_CASES(NOEXCEPT_BENCHMARK_DECLARE_TEST_CASE)
 }
+
+#undef NOEXCEPT_BENCHMARK_DECLARE_TEST_CASE
@@ -0,0 +1,31 @@
+/*
+Copyright Niels Dekker, LKEB, Leiden University Medical Center
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0.txt
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Declares the noexcept and the implicit lib of a variant of the libs, built
+// by other compiler options, in their own namespaces, like noexcept_lib_O2
+// and implicit_lib_O2, for the variant NOEXCEPT_BENCHMARK_LIB_VARIANT = O2.
+// Like lib.h, it may be included more than once, for different variants.
+
+#define NOEXCEPT_BENCHMARK_EXCEPTION_SPECIFIER noexcept
+#define NOEXCEPT_BENCHMARK_LIB_NAME NOEXCEPT_BENCHMARK_CONCATENATE(noexcept_lib_, NOEXCEPT_BENCHMARK_LIB_VARIANT)
+#include "lib.h"
+#undef NOEXCEPT_BENCHMARK_LIB_NAME
+#undef NOEXCEPT_BENCHMARK_EXCEPTION_SPECIFIER
+#define NOEXCEPT_BENCHMARK_EXCEPTION_SPECIFIER
+#define NOEXCEPT_BENCHMARK_LIB_NAME NOEXCEPT_BENCHMARK_CONCATENATE(implicit_lib_, NOEXCEPT_BENCHMARK_LIB_VARIANT)
+#include "lib.h"
+#undef NOEXCEPT_BENCHMARK_LIB_NAME
+#undef NOEXCEPT_BENCHMARK_EXCEPTION_SPECIFIER
@@ -0,0 +1,136 @@
+/*
+Copyright Niels Dekker, LKEB, Leiden University Medical Center
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0.txt
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// The move audit (--audit): counts the copy and move operations of the
+// elements of standard operations, on a counting_wrapper of my_string, whose
+// move operations have the optional exception specifier.
+
+#include "noexcept_benchmark.h"
+#include "my_string.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#if NOEXCEPT_BENCHMARK_HAS_CXX17_TEST_CASES
+#  include <variant>
+#endif
+
+namespace
+{
+  using audited_string = noexcept_benchmark::counting_wrapper<my_string, SPECIFY_NOEXCEPT != 0>;
+
+
+  // N elements, in reverse order of their keys, without spare capacity.
+  std::vector<audited_string> make_audited_strings(const unsigned number_of_elements)
+  {
+    std::vector<audited_string> result;
+    result.reserve(number_of_elements);
+
+    for (unsigned i = 0; i < number_of_elements; ++i)
+    {
+      result.emplace_back(my_string(1), number_of_elements - i);
+    }
+    return result;
+  }
+
+
+  // Returns the counts of the operation on N elements, excluding those of
+  // creating the elements.
+  template <typename Operation>
+  noexcept_benchmark::copy_move_counts count_copy_move_operations(const unsigned number_of_elements,
+    const Operation operation)
+  {
+    std::vector<audited_string> elements = make_audited_strings(number_of_elements);
+    audited_string::get_counts() = {};
+    operation(elements);
+    return audited_string::get_counts();
+  }
+}
+
+
+NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT
+const noexcept_benchmark::move_audit_entry* LIB_NAME::get_move_audit(const unsigned number_of_elements)
+{
+  static std::vector<noexcept_benchmark::move_audit_entry> entries;
+
+  const auto add_entry = [number_of_elements](const char* const operation, void (*const func)(std::vector<audited_string>&))
+  {
+    entries.push_back({ operation, count_copy_move_operations(number_of_elements, func) });
+  };
+
+  entries.clear();
+  add_entry("std::vector push_back growth", [](std::vector<audited_string>& elements)
+  {
+    std::vector<audited_string> result;
+
+    for (audited_string& element : elements)
+    {
+      result.push_back(std::move(element));
+    }
+  });
+  add_entry("std::vector reserve", [](std::vector<audited_string>& elements)
+  {
+    elements.reserve(elements.capacity() + 1);
+  });
+  add_entry("std::vector insert in the middle", [](std::vector<audited_string>& elements)
+  {
+    elements.insert(elements.begin() + static_cast<std::ptrdiff_t>(elements.size() / 2), audited_string(my_string(1), 0));
+  });
+  add_entry("std::swap", [](std::vector<audited_string>& elements)
+  {
+    for (std::size_t i = 0; i < elements.size() / 2; ++i)
+    {
+      std::swap(elements[i], elements[elements.size() - 1 - i]);
+    }
+  });
+  add_entry("std::sort", [](std::vector<audited_string>& elements)
+  {
+    std::sort(elements.begin(), elements.end());
+  });
+  add_entry("std::stable_partition", [](std::vector<audited_string>& elements)
+  {
+    std::stable_partition(elements.begin(), elements.end(), [](const audited_string& element)
+    {
+      return element.key % 2 == 0;
+    });
+  });
+#if NOEXCEPT_BENCHMARK_HAS_CXX17_TEST_CASES
+  add_entry("std::variant emplace", [](std::vector<audited_string>& elements)
+  {
+    std::variant<int, audited_string> object;
+
+    for (const audited_string& element : elements)
+    {
+      object.emplace<audited_string>(element);
+    }
+  });
+  // A converting assignment makes a temporary copy, and moves it into the
+  // variant, only when this move is noexcept.
+  add_entry("std::variant converting assignment", [](std::vector<audited_string>& elements)
+  {
+    std::variant<int, audited_string> object;
+
+    for (const audited_string& element : elements)
+    {
+      object = 0;
+      object = element;
+    }
+  });
+#endif
+  entries.push_back({ nullptr, {} });
+  return entries.data();
+}
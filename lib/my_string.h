@@ -0,0 +1,389 @@
+#ifndef noexcept_benchmark_my_string_h
+#define noexcept_benchmark_my_string_h
+
+/*
+Copyright Niels Dekker, LKEB, Leiden University Medical Center
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0.txt
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "noexcept_benchmark.h"
+#include "noexcept_benchmark_pages.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef _MSC_VER  // Microsoft Visual C++
+#  pragma warning(disable: 4996) // 'strcpy': This function or variable may be unsafe
+#endif
+
+// In an unnamed namespace, because its move operations are noexcept in one lib
+// and not in the other, while their mangled names would be the same.
+namespace
+{
+  // Allocates the buffers of my_string by the global operator new[].
+  struct heap_allocation
+  {
+    static char* allocate(const std::size_t number_of_bytes)
+    {
+      return new char[number_of_bytes];
+    }
+
+    static void deallocate(char* const buffer)
+    {
+      delete[] buffer;
+    }
+  };
+
+
+  // Allocates the buffers of my_arena_string from large chunks of memory, by
+  // bumping a pointer. Deallocation is a no-op: the memory is only released by
+  // release(), when none of the buffers is in use anymore.
+  class arena_allocation
+  {
+    static const std::size_t chunk_size = 1 << 20;
+
+    struct arena
+    {
+      std::vector<std::unique_ptr<char[]>> chunks;
+      char* position = nullptr;
+      std::size_t number_of_available_bytes = 0;
+    };
+
+    static arena& get_arena()
+    {
+      static arena result;
+      return result;
+    }
+
+  public:
+    static char* allocate(const std::size_t number_of_bytes)
+    {
+      arena& a = get_arena();
+
+      if (number_of_bytes > a.number_of_available_bytes)
+      {
+        // Note: std::max(number_of_bytes, chunk_size) would odr-use chunk_size.
+        const std::size_t size = (number_of_bytes > chunk_size) ? number_of_bytes : chunk_size;
+        a.chunks.emplace_back(new char[size]);
+        a.position = a.chunks.back().get();
+        a.number_of_available_bytes = size;
+      }
+      char* const result = a.position;
+      a.position += number_of_bytes;
+      a.number_of_available_bytes -= number_of_bytes;
+      return result;
+    }
+
+    static void deallocate(char*)
+    {
+    }
+
+    static void release()
+    {
+      arena& a = get_arena();
+      a.chunks.clear();
+      a.position = nullptr;
+      a.number_of_available_bytes = 0;
+    }
+  };
+
+
+  // Allocates the buffers of my_page_string from chunks of memory from
+  // noexcept_benchmark::allocate_pages, as specified by --huge-pages, --prefault
+  // and --numa. Like operator new[] and delete[], a deallocated buffer is reused
+  // by the next allocation of its size, from a free list per size class (a
+  // multiple of 16 bytes). The size of a buffer is derived from its string, as
+  // basic_my_string 'knows' its buffer size. The memory is only returned to the
+  // OS by release(), when none of the buffers is in use anymore.
+  class page_allocation
+  {
+    static const std::size_t size_class_granularity = 16;
+
+    struct pool
+    {
+      std::vector<std::pair<void*, std::size_t>> chunks;
+      char* position = nullptr;
+      std::size_t number_of_available_bytes = 0;
+
+      // The first free buffer of each size class, which holds the address of the next one.
+      std::vector<char*> free_lists;
+    };
+
+    static pool& get_pool()
+    {
+      static pool result;
+      return result;
+    }
+
+    static std::size_t get_slot_size(const std::size_t number_of_bytes)
+    {
+      return (number_of_bytes + size_class_granularity - 1) / size_class_granularity * size_class_granularity;
+    }
+
+    static void add_chunk(const std::size_t number_of_bytes)
+    {
+      pool& p = get_pool();
+      const std::size_t size = noexcept_benchmark::round_up_to_huge_pages(number_of_bytes);
+      p.chunks.reserve(p.chunks.size() + 1);
+      p.chunks.emplace_back(noexcept_benchmark::allocate_placed_pages(size), size);
+      p.position = static_cast<char*>(p.chunks.back().first);
+      p.number_of_available_bytes = size;
+    }
+
+  public:
+    static char* allocate(const std::size_t number_of_bytes)
+    {
+      pool& p = get_pool();
+      const std::size_t slot_size = get_slot_size(number_of_bytes);
+      const std::size_t size_class = slot_size / size_class_granularity;
+
+      if ((size_class < p.free_lists.size()) && (p.free_lists[size_class] != nullptr))
+      {
+        char* const result = p.free_lists[size_class];
+        std::memcpy(&p.free_lists[size_class], result, sizeof(char*));
+        return result;
+      }
+      if (slot_size > p.number_of_available_bytes)
+      {
+        add_chunk(slot_size);
+      }
+      char* const result = p.position;
+      p.position += slot_size;
+      p.number_of_available_bytes -= slot_size;
+      return result;
+    }
+
+    static void deallocate(char* const buffer)
+    {
+      if (buffer != nullptr)
+      {
+        pool& p = get_pool();
+        const std::size_t size_class = get_slot_size(std::strlen(buffer) + 1) / size_class_granularity;
+
+        if (size_class >= p.free_lists.size())
+        {
+          p.free_lists.resize(size_class + 1);
+        }
+        std::memcpy(buffer, &p.free_lists[size_class], sizeof(char*));
+        p.free_lists[size_class] = buffer;
+      }
+    }
+
+    // Ensures that the specified number of buffers can be allocated without
+    // adding a chunk, so that the chunk is allocated (and pre-faulted, by
+    // --prefault) in advance, before the timed code.
+    static void reserve(const std::size_t number_of_buffers, const std::size_t number_of_bytes_per_buffer)
+    {
+      const std::size_t number_of_bytes = number_of_buffers * get_slot_size(number_of_bytes_per_buffer);
+
+      if (number_of_bytes > get_pool().number_of_available_bytes)
+      {
+        add_chunk(number_of_bytes);
+      }
+    }
+
+    static void release()
+    {
+      pool& p = get_pool();
+
+      for (const std::pair<void*, std::size_t>& chunk : p.chunks)
+      {
+        noexcept_benchmark::deallocate_pages(chunk.first, chunk.second);
+      }
+      p = pool{};
+    }
+  };
+
+
+  // A string with a copy constructor that allocates, and move operations that
+  // have the optional exception specifier, so that standard containers only
+  // move its elements when SPECIFY_NOEXCEPT is 1, and copy them otherwise.
+  template <typename Allocation>
+  class basic_my_string
+  {
+    char* m_data = nullptr;
+  public:
+    basic_my_string() = default;
+
+    explicit basic_my_string(std::size_t arg)
+      :
+      m_data{ (arg == 0) ? nullptr : Allocation::allocate(arg + 1) }
+    {
+      if (arg > 0)
+      {
+        // Ensure that strlen(m_data) == arg, so that my_string 'knows' its buffer size.
+        std::fill_n(m_data, arg, ' ');
+        m_data[arg] = '\0';
+      }
+    }
+
+    basic_my_string(const basic_my_string& arg)
+      :
+      m_data{ arg.m_data }
+    {
+      if (m_data != nullptr)
+      {
+        m_data = std::strcpy(
+          Allocation::allocate(std::strlen(m_data) + 1), m_data);
+      }
+    }
+
+    basic_my_string(basic_my_string&& arg) OPTIONAL_EXCEPTION_SPECIFIER
+      :
+      m_data{ arg.m_data }
+    {
+      arg.m_data = nullptr;
+    }
+
+    basic_my_string& operator=(const basic_my_string& arg)
+    {
+      *this = basic_my_string{ arg };
+      return *this;
+    }
+
+    // Swaps, so that the old buffer is deallocated by the destructor of arg,
+    // instead of being leaked, as the container test cases move-assign their
+    // elements (insert, and std::optional and std::variant assignment).
+    basic_my_string& operator=(basic_my_string&& arg) OPTIONAL_EXCEPTION_SPECIFIER
+    {
+      std::swap(m_data, arg.m_data);
+      return *this;
+    }
+
+    ~basic_my_string()
+    {
+      Allocation::deallocate(m_data);
+    }
+
+  };
+
+  using my_string = basic_my_string<heap_allocation>;
+  using my_arena_string = basic_my_string<arena_allocation>;
+  using my_page_string = basic_my_string<page_allocation>;
+
+
+  // Tells whether an object of type T may be moved to another address by
+  // copying its bytes, without calling its move constructor and destructor.
+  template <typename T>
+  struct is_trivially_relocatable : std::is_trivially_copyable<T>
+  {
+  };
+
+  // basic_my_string only holds a pointer to its buffer, which does not refer
+  // back to the object itself.
+  template <typename Allocation>
+  struct is_trivially_relocatable<basic_my_string<Allocation>> : std::true_type
+  {
+  };
+
+
+  // A string with a small buffer optimization (SSO), like most std::string
+  // implementations: a copy of a short string does not allocate.
+  class my_sso_string
+  {
+    static const std::size_t small_buffer_size = 16;
+
+    char m_small_buffer[small_buffer_size] = {};
+    char* m_data = m_small_buffer;
+
+    bool is_small() const
+    {
+      return m_data == m_small_buffer;
+    }
+
+    // Takes the data from the argument, leaving it empty.
+    void take_data(my_sso_string& arg) OPTIONAL_EXCEPTION_SPECIFIER
+    {
+      if (arg.is_small())
+      {
+        std::memcpy(m_small_buffer, arg.m_small_buffer, small_buffer_size);
+        m_data = m_small_buffer;
+      }
+      else
+      {
+        m_data = arg.m_data;
+        arg.m_data = arg.m_small_buffer;
+      }
+      arg.m_small_buffer[0] = '\0';
+    }
+
+  public:
+    my_sso_string() = default;
+
+    explicit my_sso_string(std::size_t arg)
+      :
+      m_data{ (arg < small_buffer_size) ? m_small_buffer : new char[arg + 1] }
+    {
+      std::fill_n(m_data, arg, ' ');
+      m_data[arg] = '\0';
+    }
+
+    my_sso_string(const my_sso_string& arg)
+    {
+      const std::size_t length = std::strlen(arg.m_data);
+
+      if (length >= small_buffer_size)
+      {
+        m_data = new char[length + 1];
+      }
+      std::memcpy(m_data, arg.m_data, length + 1);
+    }
+
+    my_sso_string(my_sso_string&& arg) OPTIONAL_EXCEPTION_SPECIFIER
+    {
+      take_data(arg);
+    }
+
+    my_sso_string& operator=(const my_sso_string& arg)
+    {
+      *this = my_sso_string{ arg };
+      return *this;
+    }
+
+    my_sso_string& operator=(my_sso_string&& arg) OPTIONAL_EXCEPTION_SPECIFIER
+    {
+      if (this != &arg)
+      {
+        if (!is_small())
+        {
+          delete[] m_data;
+        }
+        take_data(arg);
+      }
+      return *this;
+    }
+
+    ~my_sso_string()
+    {
+      if (!is_small())
+      {
+        delete[] m_data;
+      }
+    }
+
+  };
+
+  static_assert(sizeof(my_string) == NOEXCEPT_BENCHMARK_SIZEOF_MY_STRING, "Check NOEXCEPT_BENCHMARK_SIZEOF_MY_STRING");
+  static_assert(sizeof(my_arena_string) == NOEXCEPT_BENCHMARK_SIZEOF_MY_STRING, "Check NOEXCEPT_BENCHMARK_SIZEOF_MY_STRING");
+  static_assert(sizeof(my_page_string) == NOEXCEPT_BENCHMARK_SIZEOF_MY_STRING, "Check NOEXCEPT_BENCHMARK_SIZEOF_MY_STRING");
+  static_assert(sizeof(my_sso_string) == NOEXCEPT_BENCHMARK_SIZEOF_MY_SSO_STRING,
+    "Check NOEXCEPT_BENCHMARK_SIZEOF_MY_SSO_STRING");
+
+}
+
+#endif
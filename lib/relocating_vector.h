@@ -0,0 +1,142 @@
+#ifndef noexcept_benchmark_relocating_vector_h
+#define noexcept_benchmark_relocating_vector_h
+
+/*
+Copyright Niels Dekker, LKEB, Leiden University Medical Center
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0.txt
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "my_string.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace
+{
+  // A minimal vector, which regrows its buffer by a single memcpy when its
+  // elements are trivially relocatable, so that they are not moved one by
+  // one, and the destructors of the original elements are not called.
+  // Otherwise, it moves its elements (when their move constructor is
+  // noexcept) or copies them, like std::vector.
+  template <typename T>
+  class relocating_vector
+  {
+    T* m_data = nullptr;
+    std::size_t m_size = 0;
+    std::size_t m_capacity = 0;
+
+    static T* allocate(const std::size_t capacity)
+    {
+      void* const result = std::malloc(capacity * sizeof(T));
+
+      if (result == nullptr)
+      {
+        NOEXCEPT_BENCHMARK_THROW(std::bad_alloc{});
+      }
+      return static_cast<T*>(result);
+    }
+
+    void destroy_elements()
+    {
+      for (std::size_t i = 0; i < m_size; ++i)
+      {
+        m_data[i].~T();
+      }
+    }
+
+    // Note: std::realloc is not used here, because for large buffers, glibc
+    // just remaps their pages, instead of copying the bytes.
+    void relocate(const std::size_t new_capacity, std::true_type /*is_trivially_relocatable*/)
+    {
+      T* const new_data = allocate(new_capacity);
+      std::memcpy(static_cast<void*>(new_data), m_data, m_size * sizeof(T));
+      std::free(m_data);
+      m_data = new_data;
+    }
+
+    void relocate(const std::size_t new_capacity, std::false_type /*is_trivially_relocatable*/)
+    {
+      T* const new_data = allocate(new_capacity);
+      std::size_t i = 0;
+
+      NOEXCEPT_BENCHMARK_TRY
+      {
+        for (; i < m_size; ++i)
+        {
+          ::new (static_cast<void*>(new_data + i)) T(std::move_if_noexcept(m_data[i]));
+        }
+      }
+      NOEXCEPT_BENCHMARK_CATCH(...)
+      {
+        while (i > 0)
+        {
+          new_data[--i].~T();
+        }
+        std::free(new_data);
+        NOEXCEPT_BENCHMARK_RETHROW;
+      }
+      destroy_elements();
+      std::free(m_data);
+      m_data = new_data;
+    }
+
+  public:
+    relocating_vector(const std::size_t size, const T& value)
+      :
+      m_data{ allocate(size) },
+      m_size{ size },
+      m_capacity{ size }
+    {
+      NOEXCEPT_BENCHMARK_TRY
+      {
+        std::uninitialized_fill(m_data, m_data + size, value);
+      }
+      NOEXCEPT_BENCHMARK_CATCH(...)
+      {
+        std::free(m_data);
+        NOEXCEPT_BENCHMARK_RETHROW;
+      }
+    }
+
+    relocating_vector(const relocating_vector&) = delete;
+    relocating_vector& operator=(const relocating_vector&) = delete;
+
+    ~relocating_vector()
+    {
+      destroy_elements();
+      std::free(m_data);
+    }
+
+    std::size_t capacity() const
+    {
+      return m_capacity;
+    }
+
+    void reserve(const std::size_t new_capacity)
+    {
+      if (new_capacity > m_capacity)
+      {
+        relocate(new_capacity, is_trivially_relocatable<T>{});
+        m_capacity = new_capacity;
+      }
+    }
+  };
+
+}
+
+#endif
@@ -0,0 +1,152 @@
+/*
+Copyright Niels Dekker, LKEB, Leiden University Medical Center
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0.txt
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Relocates N elements to a new buffer, the way std::vector does when it
+// grows: by moving them when their move constructor is noexcept, and by
+// copying them otherwise, after which the original elements are destroyed.
+// Either sequentially, or by a parallel execution policy (C++17).
+
+#include "noexcept_benchmark.h"
+#include "my_string.h"
+
+#include <iterator>
+#include <memory>
+#include <type_traits>
+
+namespace
+{
+  // Holds N elements in uninitialized storage, like the buffer of an std::vector.
+  template <typename T>
+  class raw_buffer
+  {
+    std::allocator<T> m_allocator;
+    const std::size_t m_size;
+    T* const m_data;
+
+  public:
+    explicit raw_buffer(const std::size_t size)
+      :
+      m_size{ size },
+      m_data{ m_allocator.allocate(size) }
+    {
+    }
+
+    raw_buffer(const raw_buffer&) = delete;
+    raw_buffer& operator=(const raw_buffer&) = delete;
+
+    ~raw_buffer()
+    {
+      m_allocator.deallocate(m_data, m_size);
+    }
+
+    T* begin() const
+    {
+      return m_data;
+    }
+
+    T* end() const
+    {
+      return m_data + m_size;
+    }
+  };
+
+
+  template <typename T>
+  void destroy_elements(T* const first, T* const last)
+  {
+    for (T* ptr = first; ptr != last; ++ptr)
+    {
+      ptr->~T();
+    }
+  }
+
+
+  struct sequential_relocation
+  {
+    template <typename T>
+    static void relocate(T* const first, T* const last, T* const destination, std::true_type /*is_nothrow_move*/)
+    {
+      std::uninitialized_copy(std::make_move_iterator(first), std::make_move_iterator(last), destination);
+      destroy_elements(first, last);
+    }
+
+    template <typename T>
+    static void relocate(T* const first, T* const last, T* const destination, std::false_type /*is_nothrow_move*/)
+    {
+      std::uninitialized_copy(first, last, destination);
+      destroy_elements(first, last);
+    }
+  };
+
+
+#if NOEXCEPT_BENCHMARK_HAS_EXECUTION_POLICY_TEST_CASES
+  // Uses std::execution::par, rather than par_unseq, as copying and destroying
+  // a my_string allocates and deallocates memory, which is not allowed in
+  // vectorization-unsafe code. Both paths use the same policy, so that the
+  // noexcept variant and the implicit variant remain comparable.
+  struct par_relocation
+  {
+    template <typename T>
+    static void relocate(T* const first, T* const last, T* const destination, std::true_type /*is_nothrow_move*/)
+    {
+      std::uninitialized_move(std::execution::par, first, last, destination);
+      std::destroy(std::execution::par, first, last);
+    }
+
+    template <typename T>
+    static void relocate(T* const first, T* const last, T* const destination, std::false_type /*is_nothrow_move*/)
+    {
+      std::uninitialized_copy(std::execution::par, first, last, destination);
+      std::destroy(std::execution::par, first, last);
+    }
+  };
+#endif
+
+
+  template <typename Relocation, typename T>
+  double profile_relocation(const unsigned number_of_elements)
+  {
+    const raw_buffer<T> source(number_of_elements);
+    const raw_buffer<T> destination(number_of_elements);
+    std::uninitialized_fill(source.begin(), source.end(), T(1));
+
+    const double duration = noexcept_benchmark::profile_func_call([&source, &destination]
+    {
+      Relocation::relocate(source.begin(), source.end(), destination.begin(),
+        std::is_nothrow_move_constructible<T>{});
+    });
+    destroy_elements(destination.begin(), destination.end());
+    return duration;
+  }
+}
+
+
+NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT
+double LIB_NAME::test_vector_relocate(const unsigned number_of_elements)
+{
+  return profile_relocation<sequential_relocation, my_string>(number_of_elements);
+}
+
+
+#if NOEXCEPT_BENCHMARK_HAS_EXECUTION_POLICY_TEST_CASES
+
+NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT
+double LIB_NAME::test_vector_relocate_par(const unsigned number_of_elements)
+{
+  return profile_relocation<par_relocation, my_string>(number_of_elements);
+}
+
+#endif
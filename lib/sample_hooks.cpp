@@ -0,0 +1,45 @@
+/*
+Copyright Niels Dekker, LKEB, Leiden University Medical Center
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0.txt
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "noexcept_benchmark.h"
+
+#include <cstring>
+
+
+NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT
+void LIB_NAME::set_sample_hooks(const noexcept_benchmark::sample_hooks* const hooks)
+{
+  noexcept_benchmark::get_sample_hooks() = hooks;
+}
+
+
+NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT
+void LIB_NAME::set_timer_calibration(
+  const char* const timer_name, const double seconds_per_tick, const unsigned is_counter_available)
+{
+  using noexcept_benchmark::default_timer;
+  noexcept_benchmark::timer_calibration& calibration = noexcept_benchmark::get_timer_calibration<default_timer>();
+
+  if (std::strcmp(timer_name, NOEXCEPT_BENCHMARK_TO_STRING(NOEXCEPT_BENCHMARK_TIMER)) == 0)
+  {
+    calibration.seconds_per_tick = seconds_per_tick;
+    calibration.is_counter_available = is_counter_available != 0;
+  }
+  else
+  {
+    calibration = default_timer::calibrate();
+  }
+}
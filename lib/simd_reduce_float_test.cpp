@@ -0,0 +1,47 @@
+/*
+Copyright Niels Dekker, LKEB, Leiden University Medical Center
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0.txt
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "noexcept_benchmark.h"
+#include "simd_test.h"
+
+namespace
+{
+  // The kernel sums the elements, after passing each of them to a func that
+  // may throw when the element is negative.
+  float func(const float value) OPTIONAL_EXCEPTION_SPECIFIER
+  {
+    noexcept_benchmark::throw_exception_if(value < 0);
+    return value - 50.0f;
+  }
+
+  void kernel(const float* const input, float* const output, const unsigned N)
+  {
+    float sum{};
+
+    for (unsigned i = 0; i < N; ++i)
+    {
+      sum += func(input[i]);
+    }
+    output[0] = sum;
+  }
+}
+
+
+NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT
+double LIB_NAME::test_simd_reduce_float(const unsigned N)
+{
+  return noexcept_benchmark::profile_simd_kernel<float>(N, kernel);
+}
@@ -0,0 +1,44 @@
+/*
+Copyright Niels Dekker, LKEB, Leiden University Medical Center
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0.txt
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "noexcept_benchmark.h"
+#include "simd_test.h"
+
+namespace
+{
+  // The kernel applies a three-point stencil to the elements, by calling a
+  // func that may throw when the middle element is negative.
+  float func(const float left, const float middle, const float right) OPTIONAL_EXCEPTION_SPECIFIER
+  {
+    noexcept_benchmark::throw_exception_if(middle < 0);
+    return 0.25f * (left + 2.0f * middle + right);
+  }
+
+  void kernel(const float* const input, float* const output, const unsigned N)
+  {
+    for (unsigned i = 1; i + 1 < N; ++i)
+    {
+      output[i] = func(input[i - 1], input[i], input[i + 1]);
+    }
+  }
+}
+
+
+NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT
+double LIB_NAME::test_simd_stencil_float(const unsigned N)
+{
+  return noexcept_benchmark::profile_simd_kernel<float>(N, kernel);
+}
@@ -0,0 +1,76 @@
+#ifndef noexcept_benchmark_simd_test_h
+#define noexcept_benchmark_simd_test_h
+
+/*
+Copyright Niels Dekker, LKEB, Leiden University Medical Center
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0.txt
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Runs the kernel of a simd test case (lib/simd_*_test.cpp), which applies
+// a func that may throw to each element of a buffer, in a loop that the
+// compiler may or may not vectorize. The func may be inlined, but its throw
+// depends on the element itself (it throws when the element is negative), so
+// the loop still has a real exceptional exit per element, rather than one that
+// depends on a loop-invariant bool (which the compiler could hoist out of the
+// loop). The input elements are never negative, but the compiler cannot know.
+// Each simd test case has its own source file, and the kernel loop should be
+// its only loop, so that the vectorization report of the compiler (see
+// CMakeLists.txt) tells whether that loop is vectorized. The loops of this
+// header are reported separately.
+
+#include "noexcept_benchmark.h"
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+namespace noexcept_benchmark
+{
+  // Runs the kernel repeatedly on the same N input elements, preferably as
+  // many times as it takes to process NOEXCEPT_BENCHMARK_SIMD_ELEMENTS_PER_SAMPLE
+  // elements, so that also an N that fits in the L1 cache is measurable.
+  // Returns the duration of a single run, in seconds.
+  template <typename T, typename Kernel>
+  double profile_simd_kernel(const unsigned N, const Kernel kernel)
+  {
+    const unsigned number_of_runs = std::max(NOEXCEPT_BENCHMARK_SIMD_ELEMENTS_PER_SAMPLE / N, 1u);
+    std::vector<T> input(N);
+    std::vector<T> output(N);
+
+    for (unsigned i = 0; i < N; ++i)
+    {
+      input[i] = static_cast<T>(i % 100);
+    }
+
+    const double duration = profile_func_call([number_of_runs, N, &input, &output, kernel]
+    {
+      for (unsigned run = 0; run < number_of_runs; ++run)
+      {
+        // The compiler cannot assume that the input elements are still the
+        // same, and that a run has the same output as the previous one.
+        clobber_memory();
+        kernel(input.data(), output.data(), N);
+        clobber_memory();
+      }
+    });
+
+    // So that the compiler cannot optimize away the output of the kernel.
+    T output_sum = std::accumulate(output.cbegin(), output.cend(), T{});
+    do_not_optimize(output_sum);
+
+    return duration / number_of_runs;
+  }
+}
+
+#endif
@@ -15,6 +15,7 @@ limitations under the License.
 */
 
 #include "noexcept_benchmark.h"
+#include "arrays_of_objects.h"
 
 #include <iostream>
 
@@ -27,8 +28,10 @@ namespace
     object_class()
     {
       ++m_object_counter;
-      volatile bool volatile_false = false;
-      noexcept_benchmark::throw_exception_if(volatile_false);
+      // The compiler cannot assume that this bool is always false, even though it is!
+      bool do_throw_exception = false;
+      noexcept_benchmark::do_not_optimize(do_throw_exception);
+      noexcept_benchmark::throw_exception_if(do_throw_exception);
     }
 
     ~object_class()
@@ -46,23 +49,28 @@ namespace
   unsigned object_class::m_object_counter;
 
 
-  void func() OPTIONAL_EXCEPTION_SPECIFIER
+  struct object_array
   {
-    object_class arr[NOEXCEPT_BENCHMARK_STACK_UNWINDING_OBJECTS];
-  }
+    template <unsigned array_size>
+    static void run() OPTIONAL_EXCEPTION_SPECIFIER
+    {
+      object_class arr[array_size];
+    }
+  };
 }
 
 
 NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT
-double LIB_NAME::test_stack_unwinding_array()
+double LIB_NAME::test_stack_unwinding_array(const unsigned number_of_objects)
 {
-  return noexcept_benchmark::profile_func_call([]
+  // The objects are constructed in arrays of a fixed (compile-time) size.
+  return noexcept_benchmark::profile_func_call([number_of_objects]
   {
-    try
+    NOEXCEPT_BENCHMARK_TRY
     {
-      func();
+      construct_and_destruct_arrays<object_array>(number_of_objects);
     }
-    catch (const std::exception&)
+    NOEXCEPT_BENCHMARK_CATCH(const std::exception&)
     {
       // Should never occur!
       std::cerr << "Error! object_counter = " << object_class::get_object_counter() << '\n';
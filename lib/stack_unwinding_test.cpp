@@ -17,7 +17,6 @@ limitations under the License.
 #include "noexcept_benchmark.h"
 
 #include <iostream>
-#include <ctime>
 
 namespace
 {
@@ -41,7 +40,7 @@ namespace
   struct recursion_data
   {
     int number_of_func_calls_to_do;
-    volatile bool volatile_false;
+    bool do_throw_exception;
     unsigned object_counter;
   };
 
@@ -49,7 +48,9 @@ namespace
   {
     if (--data.number_of_func_calls_to_do > 0)
     {
-      noexcept_benchmark::throw_exception_if(data.volatile_false);
+      // The compiler cannot assume that this bool is still false, even though it is!
+      noexcept_benchmark::do_not_optimize(data.do_throw_exception);
+      noexcept_benchmark::throw_exception_if(data.do_throw_exception);
       object_class stack_object(data.object_counter);
       recursive_func(data);
     }
@@ -58,22 +59,22 @@ namespace
 
 
 NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT
-double LIB_NAME::test_stack_unwinding()
+double LIB_NAME::test_stack_unwinding(const unsigned number_of_func_calls)
 {
-  return noexcept_benchmark::profile_func_call([]
+  return noexcept_benchmark::profile_func_call([number_of_func_calls]
   {
     recursion_data data
     {
-      NOEXCEPT_BENCHMARK_STACK_UNWINDING_FUNC_CALLS,
-      noexcept_benchmark::get_false(),
+      static_cast<int>(number_of_func_calls),
+      false,
       0
     };
 
-    try
+    NOEXCEPT_BENCHMARK_TRY
     {
       recursive_func(data);
     }
-    catch (const std::exception&)
+    NOEXCEPT_BENCHMARK_CATCH(const std::exception&)
     {
     }
     if (data.object_counter != 0)
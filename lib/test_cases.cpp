@@ -0,0 +1,66 @@
+/*
+Copyright Niels Dekker, LKEB, Leiden University Medical Center
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0.txt
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "noexcept_benchmark.h"
+
+
+NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT
+const noexcept_benchmark::lib_test_case* LIB_NAME::get_test_cases()
+{
+#define NOEXCEPT_BENCHMARK_LIB_TEST_CASE(func, description, min_N, default_N, max_N, bytes_per_N, is_N_calls) \
+    { #func, LIB_NAME::func },
+
+  static const noexcept_benchmark::lib_test_case test_cases[] =
+  {
+    NOEXCEPT_BENCHMARK_LIB_TEST_CASES(NOEXCEPT_BENCHMARK_LIB_TEST_CASE)
+    { nullptr, nullptr }
+  };
+
+#undef NOEXCEPT_BENCHMARK_LIB_TEST_CASE
+  return test_cases;
+}
+
+
+// The compiler that built the lib, for the descriptor.
+#if defined(__clang__)
+#  define NOEXCEPT_BENCHMARK_LIB_COMPILER "Clang " __clang_version__
+#elif defined(__GNUC__)
+#  define NOEXCEPT_BENCHMARK_LIB_COMPILER "GCC " __VERSION__
+#elif defined(_MSC_FULL_VER)
+#  define NOEXCEPT_BENCHMARK_LIB_COMPILER "MSVC " NOEXCEPT_BENCHMARK_TO_STRING(_MSC_FULL_VER)
+#else
+#  define NOEXCEPT_BENCHMARK_LIB_COMPILER "unknown"
+#endif
+
+extern "C" NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT
+const noexcept_benchmark::lib_descriptor* noexcept_benchmark_get_lib_descriptor()
+{
+  static const noexcept_benchmark::lib_descriptor descriptor =
+  {
+    NOEXCEPT_BENCHMARK_LIB_DESCRIPTOR_VERSION,
+    NOEXCEPT_BENCHMARK_TO_STRING(LIB_NAME),
+    NOEXCEPT_BENCHMARK_LIB_COMPILER,
+    SPECIFY_NOEXCEPT,
+    LIB_NAME::exported_func,
+    LIB_NAME::set_sample_hooks,
+    LIB_NAME::set_timer_calibration,
+    LIB_NAME::set_throw_path_parameters,
+    LIB_NAME::set_memory_placement,
+    LIB_NAME::get_move_audit,
+    LIB_NAME::get_test_cases
+  };
+  return &descriptor;
+}
@@ -0,0 +1,279 @@
+/*
+Copyright Niels Dekker, LKEB, Leiden University Medical Center
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0.txt
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Unlike the other tests, these tests really throw exceptions (independent of
+// NOEXCEPT_BENCHMARK_THROW_EXCEPTION), to measure the cost of the throw path.
+// N is the total number of frames: each throw goes through `depth` frames,
+// so N / depth exceptions are thrown per sample. When exceptions are disabled
+// (-fno-exceptions), only the error code test remains.
+
+#include "noexcept_benchmark.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace
+{
+  struct parameters_type
+  {
+    unsigned depth;
+    unsigned locals_per_frame;
+    unsigned exception_size;
+  };
+
+  parameters_type parameters =
+  {
+    NOEXCEPT_BENCHMARK_THROW_PATH_DEPTH,
+    NOEXCEPT_BENCHMARK_THROW_PATH_LOCALS_PER_FRAME,
+    NOEXCEPT_BENCHMARK_THROW_PATH_EXCEPTION_SIZE
+  };
+
+
+  class destructible_local
+  {
+    static unsigned m_object_counter;
+  public:
+    destructible_local() OPTIONAL_EXCEPTION_SPECIFIER
+    {
+      ++m_object_counter;
+    }
+
+    ~destructible_local()
+    {
+      --m_object_counter;
+    }
+
+    static unsigned get_object_counter()
+    {
+      return m_object_counter;
+    }
+  };
+
+  unsigned destructible_local::m_object_counter;
+
+
+  template <unsigned NumberOfLocals>
+  struct frame_locals
+  {
+    destructible_local locals[NumberOfLocals];
+  };
+
+  template <>
+  struct frame_locals<0>
+  {
+  };
+
+
+  template <unsigned ExceptionSize>
+  struct sized_exception
+  {
+    unsigned char payload[ExceptionSize];
+  };
+
+
+#if NOEXCEPT_BENCHMARK_HAS_EXCEPTIONS
+  // The exception is thrown in the innermost frame, and caught by the caller
+  // of the outermost frame.
+  template <unsigned NumberOfLocals, unsigned ExceptionSize>
+  struct propagate_strategy
+  {
+    static void recursive_func(const unsigned depth)
+    {
+      const frame_locals<NumberOfLocals> locals{};
+      (void)locals; // Unused for frame_locals<0>.
+
+      if (depth > 1)
+      {
+        recursive_func(depth - 1);
+      }
+      else
+      {
+        throw sized_exception<ExceptionSize>{};
+      }
+    }
+
+    static void run(const unsigned depth)
+    {
+      try
+      {
+        recursive_func(depth);
+      }
+      catch (const sized_exception<ExceptionSize>&)
+      {
+      }
+    }
+  };
+
+
+  // The exception is thrown and caught within the innermost frame, so that
+  // none of the frames is unwound. All of the frames have the optional
+  // noexcept specifier.
+  template <unsigned NumberOfLocals, unsigned ExceptionSize>
+  struct catch_directly_strategy
+  {
+    static void recursive_func(const unsigned depth) OPTIONAL_EXCEPTION_SPECIFIER
+    {
+      const frame_locals<NumberOfLocals> locals{};
+      (void)locals; // Unused for frame_locals<0>.
+
+      if (depth > 1)
+      {
+        recursive_func(depth - 1);
+      }
+      else
+      {
+        try
+        {
+          throw sized_exception<ExceptionSize>{};
+        }
+        catch (const sized_exception<ExceptionSize>&)
+        {
+        }
+      }
+    }
+
+    static void run(const unsigned depth)
+    {
+      recursive_func(depth);
+    }
+  };
+#endif
+
+
+  // The error is returned as an error code, from the innermost frame through
+  // all the other frames. All of the frames have the optional noexcept specifier.
+  // The exception size does not apply.
+  template <unsigned NumberOfLocals, unsigned>
+  struct error_code_strategy
+  {
+    static int recursive_func(const unsigned depth) OPTIONAL_EXCEPTION_SPECIFIER
+    {
+      const frame_locals<NumberOfLocals> locals{};
+      (void)locals; // Unused for frame_locals<0>.
+
+      if (depth > 1)
+      {
+        const int error_code = recursive_func(depth - 1);
+
+        if (error_code != 0)
+        {
+          return error_code;
+        }
+        // Should never occur!
+        std::cerr << "Error: no error code returned!\n";
+        return 0;
+      }
+      // The compiler cannot assume that this bool is always true, even though it is!
+      bool is_error = true;
+      noexcept_benchmark::do_not_optimize(is_error);
+      return is_error ? 1 : 0;
+    }
+
+    static void run(const unsigned depth)
+    {
+      int error_code = recursive_func(depth);
+      noexcept_benchmark::do_not_optimize(error_code);
+    }
+  };
+
+
+  template <typename Strategy>
+  double profile_throw_path(const unsigned number_of_throws, const unsigned depth)
+  {
+    return noexcept_benchmark::profile_func_call([number_of_throws, depth]
+    {
+      for (unsigned i = 0; i < number_of_throws; ++i)
+      {
+        Strategy::run(depth);
+      }
+    });
+  }
+
+
+  // Rounds the exception size up to 16, 256 or 4096 bytes.
+  template <template <unsigned, unsigned> class Strategy, unsigned NumberOfLocals>
+  double profile_throw_path(const unsigned number_of_throws, const unsigned depth, const unsigned exception_size)
+  {
+    return
+      (exception_size <= 16) ? profile_throw_path<Strategy<NumberOfLocals, 16>>(number_of_throws, depth) :
+      (exception_size <= 256) ? profile_throw_path<Strategy<NumberOfLocals, 256>>(number_of_throws, depth) :
+      profile_throw_path<Strategy<NumberOfLocals, 4096>>(number_of_throws, depth);
+  }
+
+
+  // Rounds the number of locals per frame up to 0, 1, 4 or 16.
+  template <template <unsigned, unsigned> class Strategy>
+  double profile_throw_path(const unsigned number_of_frames)
+  {
+    const unsigned depth = std::max(parameters.depth, 1U);
+    const unsigned number_of_throws = std::max(number_of_frames / depth, 1U);
+    const unsigned locals_per_frame = parameters.locals_per_frame;
+    const unsigned exception_size = parameters.exception_size;
+
+    const double duration =
+      (locals_per_frame == 0) ? profile_throw_path<Strategy, 0>(number_of_throws, depth, exception_size) :
+      (locals_per_frame <= 1) ? profile_throw_path<Strategy, 1>(number_of_throws, depth, exception_size) :
+      (locals_per_frame <= 4) ? profile_throw_path<Strategy, 4>(number_of_throws, depth, exception_size) :
+      profile_throw_path<Strategy, 16>(number_of_throws, depth, exception_size);
+
+    if (destructible_local::get_object_counter() != 0)
+    {
+      // Should never occur!
+      std::cerr << "Error: Incomplete stack unwinding! object_counter = "
+        << destructible_local::get_object_counter() << '\n';
+    }
+
+    // Scaled to the requested number of frames, as the number of frames that
+    // are actually run (number_of_throws * depth) may differ, when it is not a
+    // multiple of the depth.
+    return duration * number_of_frames / (static_cast<double>(number_of_throws) * depth);
+  }
+}
+
+
+NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT
+void LIB_NAME::set_throw_path_parameters(
+  const unsigned depth,
+  const unsigned locals_per_frame,
+  const unsigned exception_size)
+{
+  parameters = { depth, locals_per_frame, exception_size };
+}
+
+
+#if NOEXCEPT_BENCHMARK_HAS_EXCEPTIONS
+
+NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT
+double LIB_NAME::test_throw_path_propagate(const unsigned number_of_frames)
+{
+  return profile_throw_path<propagate_strategy>(number_of_frames);
+}
+
+
+NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT
+double LIB_NAME::test_throw_path_catch_directly(const unsigned number_of_frames)
+{
+  return profile_throw_path<catch_directly_strategy>(number_of_frames);
+}
+
+#endif
+
+
+NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT
+double LIB_NAME::test_throw_path_error_code(const unsigned number_of_frames)
+{
+  return profile_throw_path<error_code_strategy>(number_of_frames);
+}
@@ -0,0 +1,75 @@
+/*
+Copyright Niels Dekker, LKEB, Leiden University Medical Center
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0.txt
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "noexcept_benchmark.h"
+
+#include <functional>
+
+namespace
+{
+  void type_erased_func(const bool do_throw_exception) OPTIONAL_EXCEPTION_SPECIFIER
+  {
+    noexcept_benchmark::throw_exception_if(do_throw_exception);
+  }
+
+  const auto type_erased_lambda = [](const bool do_throw_exception) OPTIONAL_EXCEPTION_SPECIFIER
+  {
+    type_erased_func(do_throw_exception);
+  };
+
+  // Defined at namespace scope, so that the compiler cannot see which
+  // callable they hold, when they are called by the test functions.
+  std::function<void(bool)> std_function{ type_erased_lambda };
+
+#if NOEXCEPT_BENCHMARK_HAS_MOVE_ONLY_FUNCTION_TEST_CASES
+  // Note that its function type has the same exception specification as the callable.
+  std::move_only_function<void(bool) OPTIONAL_EXCEPTION_SPECIFIER> move_only_function{ type_erased_lambda };
+#endif
+}
+
+
+NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT
+double LIB_NAME::test_std_function_call(const unsigned number_of_func_calls)
+{
+  return noexcept_benchmark::profile_func_call([number_of_func_calls]
+  {
+    bool do_throw_exception = false;
+
+    for (unsigned i = 0; i < number_of_func_calls; ++i)
+    {
+      noexcept_benchmark::do_not_optimize(do_throw_exception);
+      std_function(do_throw_exception);
+    }
+  });
+}
+
+
+#if NOEXCEPT_BENCHMARK_HAS_MOVE_ONLY_FUNCTION_TEST_CASES
+NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT
+double LIB_NAME::test_move_only_function_call(const unsigned number_of_func_calls)
+{
+  return noexcept_benchmark::profile_func_call([number_of_func_calls]
+  {
+    bool do_throw_exception = false;
+
+    for (unsigned i = 0; i < number_of_func_calls; ++i)
+    {
+      noexcept_benchmark::do_not_optimize(do_throw_exception);
+      move_only_function(do_throw_exception);
+    }
+  });
+}
+#endif
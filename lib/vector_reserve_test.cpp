@@ -15,83 +15,98 @@ limitations under the License.
 */
 
 #include "noexcept_benchmark.h"
+#include "noexcept_benchmark_pages.h"
+#include "my_string.h"
+#include "relocating_vector.h"
 
-#include <algorithm>
 #include <vector>
-#include <cstring>
 
-#ifdef _MSC_VER  // Microsoft Visual C++
-#  pragma warning(disable: 4996) // 'strcpy': This function or variable may be unsafe
-#endif
 
 namespace
 {
-  class my_string
+  template <typename T, typename Vector = std::vector<T>>
+  double profile_reserve(const unsigned initial_vector_size)
   {
-    char* m_data = nullptr;
-  public:
-    my_string() = default;
+    Vector strings(initial_vector_size, T(1));
 
-    explicit my_string(std::size_t arg)
-      :
-      m_data{ (arg == 0) ? nullptr : new char[arg + 1] }
+    return noexcept_benchmark::profile_func_call([&strings]
     {
-      if (arg > 0)
-      {
-        // Ensure that strlen(m_data) == arg, so that my_string 'knows' its buffer size.
-        std::fill_n(m_data, arg, ' ');
-        m_data[arg] = '\0';
-      }
-    }
-
-    my_string(const my_string& arg)
-      :
-      m_data{ arg.m_data }
+      strings.reserve(strings.capacity() + 1);
+    });
+  }
+
+
+  // Like profile_reserve, but both the buffer of the vector and the buffers of
+  // its strings are in memory from allocate_pages, as specified by
+  // --huge-pages, --prefault and --numa. The memory that the reserve call
+  // needs (the new buffer of the vector and, for the copies of the implicit
+  // lib, the new buffers of the strings) is allocated in advance, so that only
+  // the relocation itself is timed, and not the page faults.
+  double profile_reserve_in_pages(const unsigned initial_vector_size)
+  {
+    double duration;
     {
-      if (m_data != nullptr)
+      std::vector<my_page_string, noexcept_benchmark::page_allocator<my_page_string>> strings(
+        initial_vector_size, my_page_string(1));
+
+      // The buffer of a my_page_string(1) has two bytes, including its terminating null character.
+      page_allocation::reserve(initial_vector_size, 2);
+      noexcept_benchmark::reserve_pages((strings.capacity() + 1) * sizeof(my_page_string));
+
+      duration = noexcept_benchmark::profile_func_call([&strings]
       {
-        m_data = std::strcpy(
-          new char[std::strlen(m_data) + 1], m_data);
-      }
+        strings.reserve(strings.capacity() + 1);
+      });
+      noexcept_benchmark::release_reserved_pages();
     }
+    page_allocation::release();
+    return duration;
+  }
+}
 
-    my_string(my_string&& arg) OPTIONAL_EXCEPTION_SPECIFIER
-      :
-      m_data{ arg.m_data }
-    {
-      arg.m_data = nullptr;
-    }
 
-    my_string& operator=(const my_string& arg)
-    {
-      *this = my_string{ arg };
-      return *this;
-    }
+NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT
+void LIB_NAME::set_memory_placement(const unsigned huge_pages, const unsigned numa, const unsigned prefault)
+{
+  noexcept_benchmark::memory_placement& placement = noexcept_benchmark::get_memory_placement();
+  placement.huge_pages = static_cast<noexcept_benchmark::huge_page_mode>(huge_pages);
+  placement.numa = static_cast<noexcept_benchmark::numa_placement>(numa);
+  placement.prefault = prefault != 0;
+}
 
-    my_string& operator=(my_string&& arg) OPTIONAL_EXCEPTION_SPECIFIER
-    {
-      m_data = arg.m_data;
-      arg.m_data = nullptr;
-      return *this;
-    }
 
-    ~my_string()
-    {
-      delete[] m_data;
-    }
+NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT
+double LIB_NAME::test_vector_reserve(const unsigned initial_vector_size)
+{
+  if (noexcept_benchmark::get_memory_placement().is_specified())
+  {
+    return profile_reserve_in_pages(initial_vector_size);
+  }
+  return profile_reserve<my_string>(initial_vector_size);
+}
 
-  };
 
+NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT
+double LIB_NAME::test_vector_reserve_arena(const unsigned initial_vector_size)
+{
+  const double duration = profile_reserve<my_arena_string>(initial_vector_size);
+  arena_allocation::release();
+  return duration;
 }
 
 
 NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT
-double LIB_NAME::test_vector_reserve()
+double LIB_NAME::test_vector_reserve_sso(const unsigned initial_vector_size)
 {
-  std::vector<my_string> strings(NOEXCEPT_BENCHMARK_INITIAL_VECTOR_SIZE, my_string(1));
+  return profile_reserve<my_sso_string>(initial_vector_size);
+}
 
-  return noexcept_benchmark::profile_func_call([&strings]
-  {
-    strings.reserve(strings.capacity() + 1);
-  });
+
+// The ceiling of what a noexcept move could reach: my_string is trivially
+// relocatable, so relocating_vector does a single memcpy, which is equally
+// fast for both libs.
+NOEXCEPT_BENCHMARK_SHARED_LIB_EXPORT
+double LIB_NAME::test_vector_reserve_relocatable(const unsigned initial_vector_size)
+{
+  return profile_reserve<my_string, relocating_vector<my_string>>(initial_vector_size);
 }
@@ -21,20 +21,101 @@ limitations under the License.
 #include <chrono>
 #include <ctime>
 #include <climits>
+#include <cstdint>
+#include <cstdlib>
 #include <exception>
+#include <utility>
+
+#ifdef _MSC_VER
+#  include <intrin.h> // For _ReadWriteBarrier.
+#endif
+
+#include "noexcept_benchmark_timer.h"
 
 
+#define NOEXCEPT_BENCHMARK_CONCATENATE_IMPL(x, y) x##y
+#define NOEXCEPT_BENCHMARK_CONCATENATE(x, y) NOEXCEPT_BENCHMARK_CONCATENATE_IMPL(x, y)
+
+// A variant of the libs (NOEXCEPT_BENCHMARK_LIB_VARIANTS in CMake) has its
+// own namespace, like noexcept_lib_O2 and implicit_lib_O2.
+#ifdef NOEXCEPT_BENCHMARK_LIB_VARIANT
+#  define NOEXCEPT_BENCHMARK_GET_LIB_NAME(lib) NOEXCEPT_BENCHMARK_CONCATENATE(lib##_, NOEXCEPT_BENCHMARK_LIB_VARIANT)
+#else
+#  define NOEXCEPT_BENCHMARK_GET_LIB_NAME(lib) lib
+#endif
+
 #ifdef SPECIFY_NOEXCEPT
 #  if SPECIFY_NOEXCEPT == 0
 #    define OPTIONAL_EXCEPTION_SPECIFIER
-#    define LIB_NAME implicit_lib
+#    define LIB_NAME NOEXCEPT_BENCHMARK_GET_LIB_NAME(implicit_lib)
 #  endif
 #  if SPECIFY_NOEXCEPT == 1
 #    define OPTIONAL_EXCEPTION_SPECIFIER noexcept
-#    define LIB_NAME noexcept_lib
+#    define LIB_NAME NOEXCEPT_BENCHMARK_GET_LIB_NAME(noexcept_lib)
 #  endif
 #endif
 
+// Allows the libs to be built with exceptions disabled (like -fno-exceptions),
+// in which case a throw aborts, and a catch block is never entered.
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+#  define NOEXCEPT_BENCHMARK_HAS_EXCEPTIONS 1
+#  define NOEXCEPT_BENCHMARK_TRY try
+#  define NOEXCEPT_BENCHMARK_CATCH(exception_declaration) catch (exception_declaration)
+#  define NOEXCEPT_BENCHMARK_THROW(exception) throw exception
+#  define NOEXCEPT_BENCHMARK_RETHROW throw
+#else
+#  define NOEXCEPT_BENCHMARK_HAS_EXCEPTIONS 0
+#  define NOEXCEPT_BENCHMARK_TRY if (true)
+#  define NOEXCEPT_BENCHMARK_CATCH(exception_declaration) else
+#  define NOEXCEPT_BENCHMARK_THROW(exception) std::abort()
+#  define NOEXCEPT_BENCHMARK_RETHROW std::abort()
+#endif
+
+#if (__cplusplus >= 201703L) || (defined(_MSVC_LANG) && (_MSVC_LANG >= 201703L))
+#  define NOEXCEPT_BENCHMARK_HAS_CXX17_TEST_CASES 1
+#else
+#  define NOEXCEPT_BENCHMARK_HAS_CXX17_TEST_CASES 0
+#endif
+
+// The parallel algorithms of the C++17 Standard Library (std::execution).
+// Left out when exceptions are disabled, as libstdc++ (PSTL) needs them.
+#if NOEXCEPT_BENCHMARK_HAS_CXX17_TEST_CASES && NOEXCEPT_BENCHMARK_HAS_EXCEPTIONS && defined(__has_include)
+#  if __has_include(<execution>)
+#    include <execution>
+#  endif
+#endif
+
+#if NOEXCEPT_BENCHMARK_HAS_EXCEPTIONS && defined(__cpp_lib_execution) && (__cpp_lib_execution >= 201603L)
+#  define NOEXCEPT_BENCHMARK_HAS_EXECUTION_POLICY_TEST_CASES 1
+#else
+#  define NOEXCEPT_BENCHMARK_HAS_EXECUTION_POLICY_TEST_CASES 0
+#endif
+
+// The coroutines of C++20, and the std::move_only_function of C++23, as
+// detected by their feature-test macros.
+#if (__cplusplus >= 202002L) || (defined(_MSVC_LANG) && (_MSVC_LANG >= 202002L))
+#  include <version>
+#endif
+
+#if defined(__cpp_impl_coroutine) && defined(__cpp_lib_coroutine)
+#  define NOEXCEPT_BENCHMARK_HAS_COROUTINE_TEST_CASES 1
+#else
+#  define NOEXCEPT_BENCHMARK_HAS_COROUTINE_TEST_CASES 0
+#endif
+
+#if defined(__cpp_lib_move_only_function)
+#  define NOEXCEPT_BENCHMARK_HAS_MOVE_ONLY_FUNCTION_TEST_CASES 1
+#else
+#  define NOEXCEPT_BENCHMARK_HAS_MOVE_ONLY_FUNCTION_TEST_CASES 0
+#endif
+
+#define NOEXCEPT_BENCHMARK_TO_STRING_IMPL(arg) #arg
+#define NOEXCEPT_BENCHMARK_TO_STRING(arg) NOEXCEPT_BENCHMARK_TO_STRING_IMPL(arg)
+
+// To be incremented with each change of noexcept_benchmark::lib_descriptor.
+#define NOEXCEPT_BENCHMARK_LIB_DESCRIPTOR_VERSION 4
+#define NOEXCEPT_BENCHMARK_GET_LIB_DESCRIPTOR_FUNC_NAME "noexcept_benchmark_get_lib_descriptor"
+
 #ifndef NOEXCEPT_BENCHMARK_NUMBER_OF_ITERATIONS
 #  define NOEXCEPT_BENCHMARK_NUMBER_OF_ITERATIONS 10
 #endif
@@ -43,6 +124,74 @@ limitations under the License.
 #  define NOEXCEPT_BENCHMARK_THROW_EXCEPTION 1
 #endif
 
+// Tells the compiler that the throw of throw_exception_if is cold: none,
+// unlikely ([[unlikely]]), expect (__builtin_expect), cold (by an out-of-line
+// thrower, marked [[gnu::cold]]) or unreachable (std::unreachable, __assume),
+// which lets the compiler assume that the throw never happens at all.
+#ifndef NOEXCEPT_BENCHMARK_THROW_HINT
+#  define NOEXCEPT_BENCHMARK_THROW_HINT none
+#endif
+
+#define NOEXCEPT_BENCHMARK_THROW_HINT_none 1
+#define NOEXCEPT_BENCHMARK_THROW_HINT_unlikely 2
+#define NOEXCEPT_BENCHMARK_THROW_HINT_expect 3
+#define NOEXCEPT_BENCHMARK_THROW_HINT_cold 4
+#define NOEXCEPT_BENCHMARK_THROW_HINT_unreachable 5
+#define NOEXCEPT_BENCHMARK_THROW_HINT_VALUE \
+  NOEXCEPT_BENCHMARK_CONCATENATE(NOEXCEPT_BENCHMARK_THROW_HINT_, NOEXCEPT_BENCHMARK_THROW_HINT)
+
+#if !NOEXCEPT_BENCHMARK_THROW_HINT_VALUE
+#  error "NOEXCEPT_BENCHMARK_THROW_HINT should be none, unlikely, expect, cold or unreachable"
+#endif
+
+#define NOEXCEPT_BENCHMARK_UNLIKELY_ATTRIBUTE
+#define NOEXCEPT_BENCHMARK_EXPECT_FALSE(condition) (condition)
+
+#if NOEXCEPT_BENCHMARK_THROW_HINT_VALUE == NOEXCEPT_BENCHMARK_THROW_HINT_unlikely
+#  ifdef __has_cpp_attribute
+#    if __has_cpp_attribute(unlikely)
+#      undef NOEXCEPT_BENCHMARK_UNLIKELY_ATTRIBUTE
+#      define NOEXCEPT_BENCHMARK_UNLIKELY_ATTRIBUTE [[unlikely]]
+#    endif
+#  endif
+#endif
+
+#if (NOEXCEPT_BENCHMARK_THROW_HINT_VALUE == NOEXCEPT_BENCHMARK_THROW_HINT_expect) && \
+  (defined(__GNUC__) || defined(__clang__))
+#  undef NOEXCEPT_BENCHMARK_EXPECT_FALSE
+#  define NOEXCEPT_BENCHMARK_EXPECT_FALSE(condition) __builtin_expect(!!(condition), 0)
+#endif
+
+#if NOEXCEPT_BENCHMARK_THROW_HINT_VALUE == NOEXCEPT_BENCHMARK_THROW_HINT_cold
+#  ifdef _MSC_VER
+#    define NOEXCEPT_BENCHMARK_COLD_FUNCTION __declspec(noinline)
+#  else
+#    define NOEXCEPT_BENCHMARK_COLD_FUNCTION __attribute__((cold, noinline))
+#  endif
+#endif
+
+#if NOEXCEPT_BENCHMARK_THROW_HINT_VALUE == NOEXCEPT_BENCHMARK_THROW_HINT_unreachable
+#  include <utility>
+#  if defined(__cpp_lib_unreachable)
+#    define NOEXCEPT_BENCHMARK_UNREACHABLE() std::unreachable()
+#  elif defined(_MSC_VER)
+#    define NOEXCEPT_BENCHMARK_UNREACHABLE() __assume(0)
+#  else
+#    define NOEXCEPT_BENCHMARK_UNREACHABLE() __builtin_unreachable()
+#  endif
+#endif
+
+// Default parameters of the throw_path tests, which may be changed at runtime.
+#ifndef NOEXCEPT_BENCHMARK_THROW_PATH_DEPTH
+#  define NOEXCEPT_BENCHMARK_THROW_PATH_DEPTH 100
+#endif
+#ifndef NOEXCEPT_BENCHMARK_THROW_PATH_LOCALS_PER_FRAME
+#  define NOEXCEPT_BENCHMARK_THROW_PATH_LOCALS_PER_FRAME 1
+#endif
+#ifndef NOEXCEPT_BENCHMARK_THROW_PATH_EXCEPTION_SIZE
+#  define NOEXCEPT_BENCHMARK_THROW_PATH_EXCEPTION_SIZE 16
+#endif
+
 
 #ifdef NDEBUG
 #  ifndef NOEXCEPT_BENCHMARK_NUMBER_OF_INLINE_FUNC_CALLS
@@ -65,9 +214,33 @@ limitations under the License.
 // Note: On Windows 10, x64, stack overflow occurred with N = 1280000
 #    define NOEXCEPT_BENCHMARK_STACK_UNWINDING_OBJECTS 1000000 // a million
 #  endif
+// The maximum N of the stack unwinding tests, which needs a larger stack (--stack-size).
+#  ifndef NOEXCEPT_BENCHMARK_MAX_STACK_UNWINDING_FUNC_CALLS
+#    define NOEXCEPT_BENCHMARK_MAX_STACK_UNWINDING_FUNC_CALLS 10000000 // ten million
+#  endif
+#  ifndef NOEXCEPT_BENCHMARK_MAX_STACK_UNWINDING_OBJECTS
+#    define NOEXCEPT_BENCHMARK_MAX_STACK_UNWINDING_OBJECTS 100000000 // a hundred million
+#  endif
 #  ifndef NOEXCEPT_BENCHMARK_INITIAL_VECTOR_SIZE
 #    define NOEXCEPT_BENCHMARK_INITIAL_VECTOR_SIZE 10000000 // ten million
 #  endif
+#  ifndef NOEXCEPT_BENCHMARK_THROW_PATH_FRAMES
+#    define NOEXCEPT_BENCHMARK_THROW_PATH_FRAMES 1000000 // a million
+#  endif
+#  ifndef NOEXCEPT_BENCHMARK_NUMBER_OF_CONTAINER_ELEMENTS
+#    define NOEXCEPT_BENCHMARK_NUMBER_OF_CONTAINER_ELEMENTS 1000000 // a million
+#  endif
+// The simd test cases process their N elements repeatedly, up to the number
+// of elements per sample. Their maximum N is far beyond the L3 cache size.
+#  ifndef NOEXCEPT_BENCHMARK_NUMBER_OF_SIMD_ELEMENTS
+#    define NOEXCEPT_BENCHMARK_NUMBER_OF_SIMD_ELEMENTS 1000000 // a million
+#  endif
+#  ifndef NOEXCEPT_BENCHMARK_MAX_SIMD_ELEMENTS
+#    define NOEXCEPT_BENCHMARK_MAX_SIMD_ELEMENTS 100000000 // a hundred million
+#  endif
+#  ifndef NOEXCEPT_BENCHMARK_SIMD_ELEMENTS_PER_SAMPLE
+#    define NOEXCEPT_BENCHMARK_SIMD_ELEMENTS_PER_SAMPLE 100000000 // a hundred million
+#  endif
 #else
 #  define NOEXCEPT_BENCHMARK_NUMBER_OF_INLINE_FUNC_CALLS 42
 #  define NOEXCEPT_BENCHMARK_NUMBER_OF_EXPORTED_FUNC_CALLS 42
@@ -75,19 +248,40 @@ limitations under the License.
 #  define NOEXCEPT_BENCHMARK_INC_AND_DEC_FUNC_CALLS 42
 #  define NOEXCEPT_BENCHMARK_STACK_UNWINDING_FUNC_CALLS 42
 #  define NOEXCEPT_BENCHMARK_STACK_UNWINDING_OBJECTS 42
+#  define NOEXCEPT_BENCHMARK_MAX_STACK_UNWINDING_FUNC_CALLS 42
+#  define NOEXCEPT_BENCHMARK_MAX_STACK_UNWINDING_OBJECTS 42
 #  define NOEXCEPT_BENCHMARK_INITIAL_VECTOR_SIZE 42
+#  define NOEXCEPT_BENCHMARK_THROW_PATH_FRAMES 42
+#  define NOEXCEPT_BENCHMARK_NUMBER_OF_CONTAINER_ELEMENTS 42
+#  define NOEXCEPT_BENCHMARK_NUMBER_OF_SIMD_ELEMENTS 42
+#  define NOEXCEPT_BENCHMARK_MAX_SIMD_ELEMENTS 42
+#  define NOEXCEPT_BENCHMARK_SIMD_ELEMENTS_PER_SAMPLE 42
 #endif
 
 
 namespace noexcept_benchmark
 {
+#if NOEXCEPT_BENCHMARK_THROW_HINT_VALUE == NOEXCEPT_BENCHMARK_THROW_HINT_cold
+  // The out-of-line thrower of throw_exception_if.
+  NOEXCEPT_BENCHMARK_COLD_FUNCTION inline void throw_exception()
+  {
+    NOEXCEPT_BENCHMARK_THROW(std::exception{});
+  }
+#endif
+
   inline void throw_exception_if(const bool do_throw_exception)
   {
-    if (do_throw_exception)
+    if (NOEXCEPT_BENCHMARK_EXPECT_FALSE(do_throw_exception)) NOEXCEPT_BENCHMARK_UNLIKELY_ATTRIBUTE
     {
       assert(!"This function should only be called with do_throw_exception = false!");
-#if NOEXCEPT_BENCHMARK_THROW_EXCEPTION
-      throw std::exception{};
+#if NOEXCEPT_BENCHMARK_THROW_HINT_VALUE == NOEXCEPT_BENCHMARK_THROW_HINT_unreachable
+      NOEXCEPT_BENCHMARK_UNREACHABLE();
+#elif NOEXCEPT_BENCHMARK_THROW_EXCEPTION
+#  if NOEXCEPT_BENCHMARK_THROW_HINT_VALUE == NOEXCEPT_BENCHMARK_THROW_HINT_cold
+      throw_exception();
+#  else
+      NOEXCEPT_BENCHMARK_THROW(std::exception{});
+#  endif
 #endif
     }
   }
@@ -101,16 +295,205 @@ namespace noexcept_benchmark
   }
 
 
+  // Like benchmark::DoNotOptimize and benchmark::ClobberMemory, from Google
+  // Benchmark. do_not_optimize(value) tells the compiler that the value is
+  // used (so that its computation cannot be optimized away), and that it may
+  // be modified (so that its value cannot be assumed to stay the same, for
+  // example, to stay false), without any extra instructions. clobber_memory()
+  // tells the compiler that all memory may be read and written.
+#if defined(__GNUC__) || defined(__clang__)
   template <typename T>
+  inline void do_not_optimize(T& value)
+  {
+    // The order of the alternatives that works best, as used by Google Benchmark.
+#  ifdef __clang__
+    asm volatile("" : "+r,m"(value) : : "memory");
+#  else
+    asm volatile("" : "+m,r"(value) : : "memory");
+#  endif
+  }
+
+  inline void clobber_memory()
+  {
+    asm volatile("" : : : "memory");
+  }
+#else
+  inline const volatile void*& get_do_not_optimize_sink()
+  {
+    static const volatile void* sink = nullptr;
+    return sink;
+  }
+
+  template <typename T>
+  inline void do_not_optimize(T& value)
+  {
+    // Publishing the address of the value lets it escape.
+    get_do_not_optimize_sink() = &value;
+    _ReadWriteBarrier();
+  }
+
+  inline void clobber_memory()
+  {
+    _ReadWriteBarrier();
+  }
+#endif
+
+
+  // Optional hooks, called just before and just after each profiled function
+  // call, for example to read hardware performance counters. C-compatible, as
+  // they may be passed to a lib that is built by another compiler.
+  struct sample_hooks
+  {
+    void* context;
+    void (*start)(void* context);
+    void (*stop)(void* context);
+  };
+
+
+  // A test function of a lib, by its name. C-compatible, like sample_hooks.
+  struct lib_test_case
+  {
+    const char* func_name;
+    double (*func)(unsigned N);
+  };
+
+
+  // The numbers of copy and move operations of the elements of a container.
+  // C-compatible, like sample_hooks.
+  struct copy_move_counts
+  {
+    std::uint64_t copy_constructions;
+    std::uint64_t move_constructions;
+    std::uint64_t copy_assignments;
+    std::uint64_t move_assignments;
+  };
+
+
+  // The copy and move operations of a standard operation (like "std::sort"),
+  // as counted by the move audit of a lib (--audit).
+  struct move_audit_entry
+  {
+    const char* operation;
+    copy_move_counts counts;
+  };
+
+
+  // Wraps a value of type T, and counts its copy and move operations. Its move
+  // operations are noexcept when IsNoexcept is true. Ordered by its key, so
+  // that it can be sorted. Making a user-defined type T the value of this
+  // wrapper shows whether a standard operation deep-copies its elements,
+  // because their move operations are not noexcept.
+  template <typename T, bool IsNoexcept>
+  class counting_wrapper
+  {
+  public:
+    T value;
+    unsigned key = 0;
+
+    // The counts of all the objects of this type. For a single thread only.
+    static copy_move_counts& get_counts()
+    {
+      static copy_move_counts counts{};
+      return counts;
+    }
+
+    counting_wrapper() = default;
+
+    counting_wrapper(T arg, const unsigned arg_key)
+      :
+      value(std::move(arg)),
+      key(arg_key)
+    {
+    }
+
+    counting_wrapper(const counting_wrapper& arg)
+      :
+      value(arg.value),
+      key(arg.key)
+    {
+      ++get_counts().copy_constructions;
+    }
+
+    counting_wrapper(counting_wrapper&& arg) noexcept(IsNoexcept)
+      :
+      value(std::move(arg.value)),
+      key(arg.key)
+    {
+      ++get_counts().move_constructions;
+    }
+
+    counting_wrapper& operator=(const counting_wrapper& arg)
+    {
+      value = arg.value;
+      key = arg.key;
+      ++get_counts().copy_assignments;
+      return *this;
+    }
+
+    counting_wrapper& operator=(counting_wrapper&& arg) noexcept(IsNoexcept)
+    {
+      value = std::move(arg.value);
+      key = arg.key;
+      ++get_counts().move_assignments;
+      return *this;
+    }
+
+    friend bool operator<(const counting_wrapper& lhs, const counting_wrapper& rhs)
+    {
+      return lhs.key < rhs.key;
+    }
+  };
+
+
+  // Describes a lib to the executable, by the extern "C" function
+  // noexcept_benchmark_get_lib_descriptor(). C-compatible, so that a lib that
+  // is built by another compiler can be loaded as a plugin (--plugin).
+  struct lib_descriptor
+  {
+    // Should be NOEXCEPT_BENCHMARK_LIB_DESCRIPTOR_VERSION.
+    unsigned version;
+    const char* lib_name;
+    const char* compiler;
+    int is_noexcept;
+    void (*exported_func)(bool);
+    void (*set_sample_hooks)(const sample_hooks*);
+    void (*set_timer_calibration)(const char*, double, unsigned);
+    void (*set_throw_path_parameters)(unsigned, unsigned, unsigned);
+    void (*set_memory_placement)(unsigned, unsigned, unsigned);
+    const move_audit_entry* (*get_move_audit)(unsigned);
+    const lib_test_case* (*get_test_cases)();
+  };
+
+
+  // The sample hooks of the current module (the executable or a lib). Each lib
+  // exports set_sample_hooks, to set its own.
+  inline const sample_hooks*& get_sample_hooks()
+  {
+    static const sample_hooks* hooks = nullptr;
+    return hooks;
+  }
+
+
+  // Returns the duration of the function call, in seconds, as measured by the
+  // specified timer policy (from noexcept_benchmark_timer.h).
+  template <typename Timer = default_timer, typename T>
   double profile_func_call(T func)
   {
-    using namespace std::chrono;
+    const sample_hooks* const hooks = get_sample_hooks();
 
-    const auto time_point1 = high_resolution_clock::now();
+    if (hooks != nullptr)
+    {
+      hooks->start(hooks->context);
+    }
+    const auto ticks1 = Timer::start();
     func();
-    const auto time_point2 = high_resolution_clock::now();
+    const auto ticks2 = Timer::stop();
 
-    return duration_cast<duration<double>>(time_point2 - time_point1).count();
+    if (hooks != nullptr)
+    {
+      hooks->stop(hooks->context);
+    }
+    return static_cast<double>(ticks2 - ticks1) * Timer::get_seconds_per_tick();
   }
 
 }
@@ -126,6 +509,10 @@ namespace noexcept_benchmark
 #undef NOEXCEPT_BENCHMARK_LIB_NAME
 #undef NOEXCEPT_BENCHMARK_EXCEPTION_SPECIFIER
 
+#ifdef NOEXCEPT_BENCHMARK_LIB_VARIANT
+#  include "lib/lib_variant.h"
+#endif
+
 
 
 #endif
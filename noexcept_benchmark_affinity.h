@@ -0,0 +1,84 @@
+#ifndef noexcept_benchmark_affinity_h
+#define noexcept_benchmark_affinity_h
+
+/*
+Copyright Niels Dekker, LKEB, Leiden University Medical Center
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0.txt
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Pinning of the calling thread to a specific CPU, to avoid migrations
+// between the timed calls, and raising the priority of the process, to
+// reduce preemption by other processes.
+
+#include <climits>
+
+#ifdef __linux__
+#  include <sched.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#  include <sys/resource.h>
+#endif
+
+#ifdef _WIN32
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#endif
+
+
+namespace noexcept_benchmark
+{
+  // Returns true when the calling thread is successfully pinned to the CPU
+  // with the specified (zero-based) index. Not supported on macOS, which only
+  // offers affinity hints.
+  inline bool pin_current_thread(const unsigned cpu_index)
+  {
+#ifdef __linux__
+    if (cpu_index >= CPU_SETSIZE)
+    {
+      return false;
+    }
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(cpu_index, &cpu_set);
+    return sched_setaffinity(0, sizeof(cpu_set), &cpu_set) == 0;
+#elif defined(_WIN32)
+    return (cpu_index < CHAR_BIT * sizeof(DWORD_PTR)) &&
+      (SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR{ 1 } << cpu_index) != 0);
+#else
+    (void)cpu_index;
+    return false;
+#endif
+  }
+
+
+  // Returns true when the priority of the calling process is successfully
+  // raised to the highest nice value (which usually needs elevated
+  // privileges), or, on Windows, to the high priority class.
+  inline bool raise_current_process_priority()
+  {
+#ifdef _WIN32
+    return SetPriorityClass(GetCurrentProcess(), HIGH_PRIORITY_CLASS) != 0;
+#elif defined(__unix__) || defined(__APPLE__)
+    return setpriority(PRIO_PROCESS, 0, -20) == 0;
+#else
+    return false;
+#endif
+  }
+
+}
+
+#endif
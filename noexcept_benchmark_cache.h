@@ -0,0 +1,123 @@
+#ifndef noexcept_benchmark_cache_h
+#define noexcept_benchmark_cache_h
+
+/*
+Copyright Niels Dekker, LKEB, Leiden University Medical Center
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0.txt
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// An on-disk cache of test case records (--cache-dir), with a file per key.
+// The key of a record consists of the hashes of the lib files of the test
+// case and of the executable, the environment (including the CPU model), the
+// settings, the test case id and its N (or "calibrated"). Its file name is
+// the hash of the key, and its content is the JSON of write_json, with the
+// key as its settings, and the record as its only test case.
+
+#include "noexcept_benchmark_input.h"
+#include "noexcept_benchmark_output.h"
+
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+
+namespace noexcept_benchmark
+{
+  // The 64-bit FNV-1a hash of the data.
+  inline std::uint64_t get_fnv1a_hash(const std::string& data)
+  {
+    std::uint64_t hash = 14695981039346656037ULL;
+
+    for (const char c : data)
+    {
+      hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+    }
+    return hash;
+  }
+
+
+  inline std::string to_hex_string(const std::uint64_t value)
+  {
+    std::string result(16, '0');
+
+    for (std::size_t i = 0; i < result.size(); ++i)
+    {
+      result[result.size() - 1 - i] = "0123456789abcdef"[(value >> (4 * i)) & 0xF];
+    }
+    return result;
+  }
+
+
+  // Returns the hash of the content of the file (as a hex string), or an empty
+  // string, when the file cannot be read. Reads each file only once.
+  inline const std::string& get_file_hash(const std::string& file_name)
+  {
+    static std::map<std::string, std::string> hashes;
+    const auto found = hashes.find(file_name);
+
+    if (found != hashes.end())
+    {
+      return found->second;
+    }
+    std::ifstream file(file_name, std::ios::binary);
+    const std::string content{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+    return hashes[file_name] = file ? to_hex_string(get_fnv1a_hash(content)) : std::string();
+  }
+
+
+  inline std::string get_result_cache_file_name(const std::string& cache_dir, const name_value_pairs& key)
+  {
+    std::string serialized_key;
+
+    for (const auto& pair : key)
+    {
+      serialized_key += pair.first + '=' + pair.second + '\n';
+    }
+    return cache_dir + '/' + to_hex_string(get_fnv1a_hash(serialized_key)) + ".json";
+  }
+
+
+  // Returns true when the file has the record of a single test case, which
+  // has the specified key as its settings.
+  inline bool read_cached_record(const std::string& file_name, const name_value_pairs& key, test_case_record& record)
+  {
+    std::ifstream file(file_name);
+    std::vector<test_case_record> records;
+    name_value_pairs settings;
+    std::string error_message;
+
+    if (file && read_json_records(file, records, error_message, &settings) && (records.size() == 1) &&
+      (settings == key))
+    {
+      record = records.front();
+      return true;
+    }
+    return false;
+  }
+
+
+  inline bool write_cached_record(const std::string& file_name, const name_value_pairs& key,
+    const test_case_record& record)
+  {
+    std::ofstream file(file_name);
+    write_json(file, {}, key, { record });
+    return static_cast<bool>(file);
+  }
+
+}
+
+#endif
@@ -0,0 +1,259 @@
+#ifndef noexcept_benchmark_code_size_h
+#define noexcept_benchmark_code_size_h
+
+/*
+Copyright Niels Dekker, LKEB, Leiden University Medical Center
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0.txt
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// The code size of a shared library: the sizes of its code and exception
+// handling sections, and the sizes of its exported functions. On Linux, read
+// from the ELF file of the library (which is found by dladdr). On Windows,
+// read from the PE image of the loaded DLL, and, on x64, from its function
+// table. Not supported on other platforms.
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#elif defined(__linux__)
+#  include <dlfcn.h>
+#  include <elf.h>
+#endif
+
+
+namespace noexcept_benchmark
+{
+  class shared_lib_code_size
+  {
+  public:
+    using section_sizes_type = std::vector<std::pair<std::string, std::uint64_t>>;
+
+    // The base address of the shared library that contains the specified address, or null, when unknown.
+    static const char* get_base_address(const void* const address_in_lib)
+    {
+#ifdef _WIN32
+      HMODULE module = nullptr;
+
+      return GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+        static_cast<LPCSTR>(address_in_lib), &module) ? reinterpret_cast<const char*>(module) : nullptr;
+#elif defined(__linux__)
+      Dl_info info{};
+      return (dladdr(address_in_lib, &info) != 0) ? static_cast<const char*>(info.dli_fbase) : nullptr;
+#else
+      (void)address_in_lib;
+      return nullptr;
+#endif
+    }
+
+    // Reads the code size of the shared library that contains the specified address.
+    explicit shared_lib_code_size(const void* const address_in_lib)
+      :
+      m_base_address{ get_base_address(address_in_lib) }
+    {
+#ifdef _WIN32
+      if (m_base_address != nullptr)
+      {
+        char file_name[MAX_PATH] = {};
+        GetModuleFileNameA(reinterpret_cast<HMODULE>(const_cast<char*>(m_base_address)), file_name, MAX_PATH);
+        m_file_name = file_name;
+        read_pe_sections();
+      }
+#elif defined(__linux__)
+      Dl_info info{};
+
+      if ((dladdr(address_in_lib, &info) != 0) && (info.dli_fname != nullptr))
+      {
+        m_file_name = info.dli_fname;
+
+        std::ifstream file(m_file_name, std::ios::binary);
+        const std::string bytes{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+
+        if ((bytes.size() > EI_CLASS) && (std::memcmp(bytes.data(), ELFMAG, SELFMAG) == 0))
+        {
+          if (bytes[EI_CLASS] == ELFCLASS64)
+          {
+            read_elf<Elf64_Ehdr, Elf64_Shdr, Elf64_Sym>(bytes);
+          }
+          else
+          {
+            read_elf<Elf32_Ehdr, Elf32_Shdr, Elf32_Sym>(bytes);
+          }
+        }
+      }
+#else
+      (void)address_in_lib;
+#endif
+    }
+
+    const std::string& get_file_name() const
+    {
+      return m_file_name;
+    }
+
+    // The sizes of the sections that hold code and exception handling data, in bytes.
+    const section_sizes_type& get_section_sizes() const
+    {
+      return m_section_sizes;
+    }
+
+    // The size of the function, in bytes, or zero, when unknown.
+    std::uint64_t get_function_size(const void* const function_address) const
+    {
+#if defined(_WIN32) && defined(_M_X64)
+      DWORD64 image_base = 0;
+      const RUNTIME_FUNCTION* const function_entry =
+        RtlLookupFunctionEntry(reinterpret_cast<DWORD64>(function_address), &image_base, nullptr);
+
+      return ((function_entry != nullptr) && (image_base == reinterpret_cast<DWORD64>(m_base_address))) ?
+        (function_entry->EndAddress - function_entry->BeginAddress) : 0;
+#else
+      const auto found = m_function_sizes.find(
+        static_cast<std::uint64_t>(static_cast<const char*>(function_address) - m_base_address));
+      return (found == m_function_sizes.cend()) ? 0 : found->second;
+#endif
+    }
+
+  private:
+    const char* m_base_address;
+    std::string m_file_name;
+    section_sizes_type m_section_sizes;
+
+    // The sizes of the exported functions, by their address, relative to the base address.
+    std::map<std::uint64_t, std::uint64_t> m_function_sizes;
+
+    static bool is_section_of_interest(const std::string& section_name)
+    {
+      for (const char* const name : { ".text", ".eh_frame", ".eh_frame_hdr", ".gcc_except_table", ".pdata", ".xdata" })
+      {
+        if (section_name == name)
+        {
+          return true;
+        }
+      }
+      return false;
+    }
+
+#ifdef _WIN32
+    void read_pe_sections()
+    {
+      const auto& dos_header = *reinterpret_cast<const IMAGE_DOS_HEADER*>(m_base_address);
+      const auto& nt_headers = *reinterpret_cast<const IMAGE_NT_HEADERS*>(m_base_address + dos_header.e_lfanew);
+      const IMAGE_SECTION_HEADER* const section_headers = IMAGE_FIRST_SECTION(&nt_headers);
+
+      for (WORD i = 0; i < nt_headers.FileHeader.NumberOfSections; ++i)
+      {
+        const char* const name = reinterpret_cast<const char*>(section_headers[i].Name);
+        const std::string section_name(name, strnlen(name, IMAGE_SIZEOF_SHORT_NAME));
+
+        if (is_section_of_interest(section_name))
+        {
+          m_section_sizes.emplace_back(section_name, section_headers[i].Misc.VirtualSize);
+        }
+      }
+    }
+#endif
+
+    // Reads the section sizes, and the sizes of the functions from the dynamic
+    // symbol table, from the bytes of an ELF file.
+    template <typename Ehdr, typename Shdr, typename Sym>
+    void read_elf(const std::string& bytes)
+    {
+      const auto is_in_file = [&bytes](const std::uint64_t offset, const std::uint64_t size)
+      {
+        return (offset <= bytes.size()) && (size <= bytes.size() - offset);
+      };
+
+      if (!is_in_file(0, sizeof(Ehdr)))
+      {
+        return;
+      }
+      Ehdr header;
+      std::memcpy(&header, bytes.data(), sizeof(header));
+
+      if ((header.e_shentsize != sizeof(Shdr)) ||
+        !is_in_file(header.e_shoff, std::uint64_t{ header.e_shnum } * sizeof(Shdr)) ||
+        (header.e_shstrndx >= header.e_shnum))
+      {
+        return;
+      }
+      std::vector<Shdr> section_headers(header.e_shnum);
+      std::memcpy(section_headers.data(), bytes.data() + header.e_shoff, section_headers.size() * sizeof(Shdr));
+
+      const Shdr& names_header = section_headers[header.e_shstrndx];
+
+      if (!is_in_file(names_header.sh_offset, names_header.sh_size))
+      {
+        return;
+      }
+      const std::string section_names = bytes.substr(names_header.sh_offset, names_header.sh_size);
+
+      for (const Shdr& section_header : section_headers)
+      {
+        if (section_header.sh_name < section_names.size())
+        {
+          const std::string section_name = section_names.c_str() + section_header.sh_name;
+
+          if (is_section_of_interest(section_name))
+          {
+            m_section_sizes.emplace_back(section_name, section_header.sh_size);
+          }
+        }
+
+        if ((section_header.sh_type == SHT_DYNSYM) && is_in_file(section_header.sh_offset, section_header.sh_size))
+        {
+          for (std::uint64_t offset = 0; offset + sizeof(Sym) <= section_header.sh_size; offset += sizeof(Sym))
+          {
+            Sym symbol;
+            std::memcpy(&symbol, bytes.data() + section_header.sh_offset + offset, sizeof(symbol));
+
+            if ((ELF64_ST_TYPE(symbol.st_info) == STT_FUNC) && (symbol.st_shndx != SHN_UNDEF))
+            {
+              m_function_sizes[symbol.st_value] = symbol.st_size;
+            }
+          }
+        }
+      }
+    }
+  };
+
+
+  // The code size of the shared library that contains the specified address,
+  // read only once per library.
+  inline const shared_lib_code_size& get_shared_lib_code_size(const void* const address_in_lib)
+  {
+    static std::map<const char*, std::unique_ptr<shared_lib_code_size>> code_sizes;
+    std::unique_ptr<shared_lib_code_size>& code_size = code_sizes[shared_lib_code_size::get_base_address(address_in_lib)];
+
+    if (code_size == nullptr)
+    {
+      code_size.reset(new shared_lib_code_size(address_in_lib));
+    }
+    return *code_size;
+  }
+
+}
+
+#endif
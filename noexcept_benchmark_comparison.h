@@ -0,0 +1,186 @@
+#ifndef noexcept_benchmark_comparison_h
+#define noexcept_benchmark_comparison_h
+
+/*
+Copyright Niels Dekker, LKEB, Leiden University Medical Center
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0.txt
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Compares the results of a run to those of a baseline run (as read by
+// read_json_records), for example to check a compiler upgrade.
+
+#include "noexcept_benchmark_output.h"
+#include "noexcept_benchmark_statistics.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <vector>
+
+
+namespace noexcept_benchmark
+{
+  // Returns the durations divided by N, so that runs with a different N can be compared.
+  inline std::vector<double> get_durations_per_unit(const std::vector<double>& durations, const unsigned N)
+  {
+    std::vector<double> result;
+
+    for (const double duration : durations)
+    {
+      result.push_back(duration / std::max(N, 1U));
+    }
+    return result;
+  }
+
+
+  struct median_comparison
+  {
+    double baseline_median;
+    double current_median;
+    double relative_change;
+    double p_value;
+  };
+
+
+  // Compares the medians of the durations per unit (duration/N) of a variant.
+  inline median_comparison get_median_comparison(
+    const variant_record& baseline,
+    const unsigned baseline_N,
+    const variant_record& current,
+    const unsigned current_N)
+  {
+    const std::vector<double> baseline_durations = get_durations_per_unit(baseline.durations, baseline_N);
+    const std::vector<double> current_durations = get_durations_per_unit(current.durations, current_N);
+    const double baseline_median = get_median(baseline_durations);
+    const double current_median = get_median(current_durations);
+
+    return
+    {
+      baseline_median,
+      current_median,
+      (baseline_median > 0.0) ? (current_median / baseline_median - 1.0) : 0.0,
+      get_mann_whitney_p_value(current_durations, baseline_durations)
+    };
+  }
+
+
+  // Prints a table of the differences between the current and the baseline
+  // results, per test case that is in both. Returns true when any of them has
+  // regressed significantly: either its ratio implicit/noexcept decreased by
+  // more than the threshold (relative), while the confidence interval of the
+  // current ratio excludes the baseline ratio, or the median duration per unit
+  // of either variant increased by more than the threshold, with a
+  // Mann-Whitney p-value below the significance level.
+  inline bool print_comparison_with_baseline(
+    std::ostream& output,
+    const std::vector<test_case_record>& baseline_records,
+    const std::vector<test_case_record>& current_records,
+    const double threshold,
+    const double significance_level)
+  {
+    const int id_width = 24;
+    const int ratio_width = 9;
+    const int change_width = 9;
+    const auto original_flags = output.flags();
+    const auto original_precision = output.precision();
+    bool has_regression = false;
+
+    output
+      << std::fixed << std::setprecision(1)
+      << "\nComparison with the baseline (threshold " << 100.0 * threshold << "%, median durations per unit)\n"
+      << std::left << std::setw(id_width) << "id" << std::right
+      << std::setw(ratio_width) << "ratio" << std::setw(ratio_width) << "baseline" << std::setw(change_width) << "change"
+      << std::setw(change_width) << "noexcept" << std::setw(change_width) << "implicit" << "  verdict\n";
+
+    for (const test_case_record& current : current_records)
+    {
+      // Prefers the baseline record with the same N, when a test case is run with multiple N values.
+      auto baseline = std::find_if(baseline_records.cbegin(), baseline_records.cend(),
+        [&current](const test_case_record& record)
+      {
+        return (record.id == current.id) && (record.N == current.N);
+      });
+
+      if (baseline == baseline_records.cend())
+      {
+        baseline = std::find_if(baseline_records.cbegin(), baseline_records.cend(),
+          [&current](const test_case_record& record)
+        {
+          return record.id == current.id;
+        });
+      }
+
+      if (baseline == baseline_records.cend())
+      {
+        output << std::left << std::setw(id_width) << current.id << std::right << "(not in the baseline)\n";
+        continue;
+      }
+
+      const ratio_comparison baseline_ratio =
+        get_ratio_comparison(baseline->implicit_variant.durations, baseline->noexcept_variant.durations);
+      const ratio_comparison current_ratio =
+        get_ratio_comparison(current.implicit_variant.durations, current.noexcept_variant.durations);
+      const double ratio_change = (baseline_ratio.ratio_of_medians > 0.0) ?
+        (current_ratio.ratio_of_medians / baseline_ratio.ratio_of_medians - 1.0) : 0.0;
+      const median_comparison noexcept_change =
+        get_median_comparison(baseline->noexcept_variant, baseline->N, current.noexcept_variant, current.N);
+      const median_comparison implicit_change =
+        get_median_comparison(baseline->implicit_variant, baseline->N, current.implicit_variant, current.N);
+
+      const bool is_ratio_regression = (ratio_change < -threshold) &&
+        (current_ratio.ratio_interval.upper < baseline_ratio.ratio_of_medians);
+      const auto is_median_regression = [threshold, significance_level](const median_comparison& comparison)
+      {
+        return (comparison.relative_change > threshold) && (comparison.p_value < significance_level);
+      };
+
+      std::string verdict;
+
+      if (is_ratio_regression)
+      {
+        verdict += " ratio";
+      }
+      if (is_median_regression(noexcept_change))
+      {
+        verdict += " noexcept";
+      }
+      if (is_median_regression(implicit_change))
+      {
+        verdict += " implicit";
+      }
+      has_regression = has_regression || !verdict.empty();
+
+      output
+        << std::left << std::setw(id_width) << current.id << std::right
+        << std::fixed << std::setprecision(3)
+        << std::setw(ratio_width) << current_ratio.ratio_of_medians
+        << std::setw(ratio_width) << baseline_ratio.ratio_of_medians
+        << std::showpos << std::setprecision(1)
+        << std::setw(change_width - 1) << 100.0 * ratio_change << '%'
+        << std::setw(change_width - 1) << 100.0 * noexcept_change.relative_change << '%'
+        << std::setw(change_width - 1) << 100.0 * implicit_change.relative_change << '%'
+        << std::noshowpos
+        << "  " << (verdict.empty() ? "ok" : "REGRESSION:" + verdict)
+        << ((current.N == baseline->N) ? "" : " (N differs)") << '\n';
+    }
+    output.flags(original_flags);
+    output.precision(original_precision);
+    output << (has_regression ? "Significant regression found!" : "No significant regression found.") << std::endl;
+    return has_regression;
+  }
+
+}
+
+#endif
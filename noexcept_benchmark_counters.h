@@ -0,0 +1,337 @@
+#ifndef noexcept_benchmark_counters_h
+#define noexcept_benchmark_counters_h
+
+/*
+Copyright Niels Dekker, LKEB, Leiden University Medical Center
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0.txt
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Hardware performance counters, read around each sample by means of
+// noexcept_benchmark::sample_hooks. Supported by perf_event_open on Linux, and
+// by the (private) kperf framework on macOS, which only offers its fixed
+// counters ("cycles" and "instructions"), and typically requires root.
+
+#include "noexcept_benchmark.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#  include <linux/perf_event.h>
+#  include <sys/ioctl.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#  include <cstring>
+#endif
+
+#ifdef __APPLE__
+#  include <dlfcn.h>
+#endif
+
+
+namespace noexcept_benchmark
+{
+  class hardware_counters
+  {
+  public:
+    // Opens the counters specified by a comma separated list of names.
+    // Check get_error_message() afterwards.
+    explicit hardware_counters(const std::string& names)
+    {
+      std::istringstream stream{ names };
+      std::string name;
+
+      while (std::getline(stream, name, ','))
+      {
+        if (!name.empty())
+        {
+          m_names.push_back(name);
+        }
+      }
+      m_values.resize(m_names.size());
+      open();
+    }
+
+    hardware_counters(const hardware_counters&) = delete;
+    hardware_counters& operator=(const hardware_counters&) = delete;
+
+    ~hardware_counters()
+    {
+#ifdef __linux__
+      for (const int file_descriptor : m_file_descriptors)
+      {
+        close(file_descriptor);
+      }
+#endif
+    }
+
+    static const char* get_supported_names()
+    {
+#ifdef __linux__
+      return "instructions, cycles, branches, branch-misses, cache-references, cache-misses, "
+        "L1d-misses, L1i-misses, LLC-misses, page-faults, context-switches";
+#elif defined(__APPLE__)
+      return "instructions, cycles";
+#else
+      return "(none)";
+#endif
+    }
+
+    // Empty when all counters are successfully opened.
+    const std::string& get_error_message() const
+    {
+      return m_error_message;
+    }
+
+    const std::vector<std::string>& get_names() const
+    {
+      return m_names;
+    }
+
+    // The counter values of the last sample.
+    const std::vector<std::int64_t>& get_values() const
+    {
+      return m_values;
+    }
+
+    sample_hooks get_sample_hooks()
+    {
+      return { this, start, stop };
+    }
+
+  private:
+    std::vector<std::string> m_names;
+    std::vector<std::int64_t> m_values;
+    std::string m_error_message;
+
+#ifdef __linux__
+    std::vector<int> m_file_descriptors;
+    std::vector<std::uint64_t> m_read_buffer;
+
+    bool get_event_type_and_config(const std::string& name, perf_event_attr& attributes)
+    {
+      struct event
+      {
+        const char* name;
+        std::uint32_t type;
+        std::uint64_t config;
+      };
+
+      const std::uint64_t read_miss =
+        (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+      const event events[] =
+      {
+        { "instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+        { "cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+        { "branches", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS },
+        { "branch-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+        { "cache-references", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES },
+        { "cache-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+        { "L1d-misses", PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | read_miss },
+        { "L1i-misses", PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1I | read_miss },
+        { "LLC-misses", PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL | read_miss },
+        { "page-faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS },
+        { "context-switches", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES }
+      };
+
+      for (const event& e : events)
+      {
+        if (name == e.name)
+        {
+          attributes.type = e.type;
+          attributes.config = e.config;
+          return true;
+        }
+      }
+      return false;
+    }
+
+    // Opens the counters as a single group, so that they are all counted at the same time.
+    void open()
+    {
+      for (const std::string& name : m_names)
+      {
+        perf_event_attr attributes;
+        std::memset(&attributes, 0, sizeof(attributes));
+        attributes.size = sizeof(attributes);
+
+        if (!get_event_type_and_config(name, attributes))
+        {
+          m_error_message = "Unsupported counter \"" + name + "\"";
+          return;
+        }
+        attributes.disabled = m_file_descriptors.empty() ? 1 : 0;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        attributes.read_format = PERF_FORMAT_GROUP;
+
+        const int group_file_descriptor = m_file_descriptors.empty() ? -1 : m_file_descriptors.front();
+        const auto file_descriptor =
+          static_cast<int>(syscall(__NR_perf_event_open, &attributes, 0, -1, group_file_descriptor, 0));
+
+        if (file_descriptor < 0)
+        {
+          m_error_message = "perf_event_open failed for counter \"" + name + "\": " + std::strerror(errno);
+          return;
+        }
+        m_file_descriptors.push_back(file_descriptor);
+      }
+      m_read_buffer.resize(1 + m_names.size());
+    }
+
+    static void start(void* const context)
+    {
+      const auto& self = *static_cast<hardware_counters*>(context);
+
+      if (!self.m_file_descriptors.empty())
+      {
+        ioctl(self.m_file_descriptors.front(), PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(self.m_file_descriptors.front(), PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+      }
+    }
+
+    static void stop(void* const context)
+    {
+      auto& self = *static_cast<hardware_counters*>(context);
+
+      if (!self.m_file_descriptors.empty())
+      {
+        ioctl(self.m_file_descriptors.front(), PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+        // With PERF_FORMAT_GROUP, the number of counters is followed by their values.
+        std::vector<std::uint64_t>& buffer = self.m_read_buffer;
+        const std::size_t number_of_bytes = buffer.size() * sizeof(buffer.front());
+
+        if (read(self.m_file_descriptors.front(), buffer.data(), number_of_bytes) ==
+          static_cast<ssize_t>(number_of_bytes))
+        {
+          for (std::size_t i = 0; i < self.m_values.size(); ++i)
+          {
+            self.m_values[i] = static_cast<std::int64_t>(buffer[i + 1]);
+          }
+        }
+      }
+    }
+
+#elif defined(__APPLE__)
+    // Function pointers to the kperf API, as used by Apple's Instruments.
+    int(*m_kpc_get_thread_counters)(std::uint32_t, std::uint32_t, std::uint64_t*) = nullptr;
+    std::vector<std::size_t> m_fixed_counter_indices;
+    std::vector<std::uint64_t> m_start_values;
+    std::vector<std::uint64_t> m_stop_values;
+
+    void open()
+    {
+      enum { kpc_class_fixed_mask = 1 };
+
+      void* const kperf = dlopen("/System/Library/PrivateFrameworks/kperf.framework/kperf", RTLD_LAZY);
+
+      if (kperf == nullptr)
+      {
+        m_error_message = "Failed to load the kperf framework";
+        return;
+      }
+      const auto kpc_get_counter_count =
+        reinterpret_cast<std::uint32_t(*)(std::uint32_t)>(dlsym(kperf, "kpc_get_counter_count"));
+      const auto kpc_set_counting = reinterpret_cast<int(*)(std::uint32_t)>(dlsym(kperf, "kpc_set_counting"));
+      const auto kpc_set_thread_counting =
+        reinterpret_cast<int(*)(std::uint32_t)>(dlsym(kperf, "kpc_set_thread_counting"));
+      m_kpc_get_thread_counters = reinterpret_cast<int(*)(std::uint32_t, std::uint32_t, std::uint64_t*)>(
+        dlsym(kperf, "kpc_get_thread_counters"));
+
+      if ((kpc_get_counter_count == nullptr) || (kpc_set_counting == nullptr) ||
+        (kpc_set_thread_counting == nullptr) || (m_kpc_get_thread_counters == nullptr))
+      {
+        m_error_message = "Failed to find the kpc functions of the kperf framework";
+        return;
+      }
+      if ((kpc_set_counting(kpc_class_fixed_mask) != 0) || (kpc_set_thread_counting(kpc_class_fixed_mask) != 0))
+      {
+        m_error_message = "Failed to enable the fixed kpc counters (root privileges required?)";
+        return;
+      }
+
+      for (const std::string& name : m_names)
+      {
+        // The fixed counters of Apple Silicon are cycles and instructions, those of Intel
+        // instructions, cycles and reference cycles.
+#ifdef __aarch64__
+        const std::size_t index = (name == "cycles") ? 0 : (name == "instructions") ? 1 : SIZE_MAX;
+#else
+        const std::size_t index = (name == "instructions") ? 0 : (name == "cycles") ? 1 : SIZE_MAX;
+#endif
+        if (index == SIZE_MAX)
+        {
+          m_error_message = "Unsupported counter \"" + name + "\"";
+          return;
+        }
+        m_fixed_counter_indices.push_back(index);
+      }
+      m_start_values.resize(std::max<std::size_t>(kpc_get_counter_count(kpc_class_fixed_mask), 2));
+      m_stop_values.resize(m_start_values.size());
+    }
+
+    static void start(void* const context)
+    {
+      auto& self = *static_cast<hardware_counters*>(context);
+
+      if (self.m_error_message.empty())
+      {
+        self.m_kpc_get_thread_counters(0, static_cast<std::uint32_t>(self.m_start_values.size()),
+          self.m_start_values.data());
+      }
+    }
+
+    static void stop(void* const context)
+    {
+      auto& self = *static_cast<hardware_counters*>(context);
+
+      if (self.m_error_message.empty())
+      {
+        self.m_kpc_get_thread_counters(0, static_cast<std::uint32_t>(self.m_stop_values.size()),
+          self.m_stop_values.data());
+
+        for (std::size_t i = 0; i < self.m_values.size(); ++i)
+        {
+          const std::size_t index = self.m_fixed_counter_indices[i];
+          self.m_values[i] = static_cast<std::int64_t>(self.m_stop_values[index] - self.m_start_values[index]);
+        }
+      }
+    }
+
+#else
+    void open()
+    {
+      m_error_message = "Hardware counters are not supported on this platform";
+    }
+
+    static void start(void*)
+    {
+    }
+
+    static void stop(void*)
+    {
+    }
+#endif
+  };
+
+}
+
+#endif
@@ -0,0 +1,187 @@
+#ifndef noexcept_benchmark_environment_h
+#define noexcept_benchmark_environment_h
+
+/*
+Copyright Niels Dekker, LKEB, Leiden University Medical Center
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0.txt
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Metadata about the build and the machine, to be stored with the results.
+
+#include "noexcept_benchmark.h"
+
+#include <climits>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <initializer_list>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef __APPLE__
+#  include <sys/sysctl.h>
+#endif
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#  include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#  include <cpuid.h>
+#endif
+
+
+namespace noexcept_benchmark
+{
+  inline std::string get_compiler_name()
+  {
+#ifdef __clang__
+    return "Clang";
+#elif defined(__GNUC__)
+    return "GCC";
+#elif defined(_MSC_VER)
+    return "MSVC";
+#else
+    return "unknown";
+#endif
+  }
+
+
+  inline std::string get_compiler_version()
+  {
+#ifdef __VERSION__
+    return __VERSION__;
+#elif defined(_MSC_FULL_VER)
+    return std::to_string(_MSC_FULL_VER);
+#else
+    return "unknown";
+#endif
+  }
+
+
+  inline std::string get_os_name()
+  {
+#ifdef _WIN32
+    return "Windows";
+#elif defined(__APPLE__)
+    return "Apple";
+#elif defined(__linux__)
+    return "Linux";
+#else
+    return "unknown";
+#endif
+  }
+
+
+  // Returns the brand string of the CPU, like "Intel(R) Core(TM) i7-8650U CPU @ 1.90GHz".
+  inline std::string get_cpu_model()
+  {
+#ifdef __linux__
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+
+    while (std::getline(cpuinfo, line))
+    {
+      // "model name" on x86, "Processor" or "Hardware" on some ARM kernels.
+      for (const char* const key : { "model name", "Processor", "Hardware" })
+      {
+        const auto colon_position = line.find(':');
+
+        if ((line.compare(0, std::strlen(key), key) == 0) && (colon_position != std::string::npos))
+        {
+          const auto value_position = line.find_first_not_of(" \t", colon_position + 1);
+
+          if (value_position != std::string::npos)
+          {
+            return line.substr(value_position);
+          }
+        }
+      }
+    }
+#endif
+#ifdef __APPLE__
+    char brand_string[256] = {};
+    std::size_t size = sizeof(brand_string) - 1;
+
+    if (sysctlbyname("machdep.cpu.brand_string", brand_string, &size, nullptr, 0) == 0)
+    {
+      return brand_string;
+    }
+#endif
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    int registers[12] = {};
+    __cpuid(registers, 0x80000002);
+    __cpuid(registers + 4, 0x80000003);
+    __cpuid(registers + 8, 0x80000004);
+    return std::string(reinterpret_cast<const char*>(registers), sizeof(registers)).c_str();
+#elif defined(__x86_64__) || defined(__i386__)
+    unsigned registers[12] = {};
+
+    if (__get_cpuid(0x80000004, registers, registers + 1, registers + 2, registers + 3))
+    {
+      __get_cpuid(0x80000002, registers, registers + 1, registers + 2, registers + 3);
+      __get_cpuid(0x80000003, registers + 4, registers + 5, registers + 6, registers + 7);
+      __get_cpuid(0x80000004, registers + 8, registers + 9, registers + 10, registers + 11);
+      return std::string(reinterpret_cast<const char*>(registers), sizeof(registers)).c_str();
+    }
+#endif
+    return "unknown";
+  }
+
+
+  // Returns the CPU frequency scaling governor (Linux only), like "performance" or "powersave".
+  inline std::string get_cpu_governor()
+  {
+    std::ifstream file("/sys/devices/system/cpu/cpu0/cpufreq/scaling_governor");
+    std::string governor;
+    return (file >> governor) ? governor : "unknown";
+  }
+
+
+  // Returns the current date and time in ISO 8601 format, as UTC.
+  inline std::string get_utc_date_time()
+  {
+    const std::time_t current_time = std::time(nullptr);
+    char buffer[sizeof("yyyy-mm-ddThh:mm:ssZ")] = {};
+    std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&current_time));
+    return buffer;
+  }
+
+
+  // Returns the metadata as name/value pairs.
+  inline std::vector<std::pair<std::string, std::string>> get_environment()
+  {
+    return
+    {
+      { "compiler", get_compiler_name() },
+      { "compiler_version", get_compiler_version() },
+      { "os", get_os_name() },
+      { "pointer_size_bits", std::to_string(CHAR_BIT * sizeof(void*)) },
+#ifdef NDEBUG
+      { "NDEBUG", "1" },
+#else
+      { "NDEBUG", "0" },
+#endif
+      { "NOEXCEPT_BENCHMARK_THROW_EXCEPTION", std::to_string(NOEXCEPT_BENCHMARK_THROW_EXCEPTION) },
+      { "NOEXCEPT_BENCHMARK_TIMER", NOEXCEPT_BENCHMARK_TO_STRING(NOEXCEPT_BENCHMARK_TIMER) },
+      { "NOEXCEPT_BENCHMARK_THROW_HINT", NOEXCEPT_BENCHMARK_TO_STRING(NOEXCEPT_BENCHMARK_THROW_HINT) },
+      { "cpu_model", get_cpu_model() },
+      { "cpu_governor", get_cpu_governor() },
+      { "date_time", get_utc_date_time() }
+    };
+  }
+
+}
+
+#endif
@@ -0,0 +1,125 @@
+#ifndef noexcept_benchmark_histogram_h
+#define noexcept_benchmark_histogram_h
+
+/*
+Copyright Niels Dekker, LKEB, Leiden University Medical Center
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0.txt
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// A histogram of latencies, in the style of HdrHistogram: the values are
+// recorded in picoseconds, in buckets whose width grows with the value, so
+// that each value is within 1/2^sub_bucket_bits (< 1%) of its bucket.
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+namespace noexcept_benchmark
+{
+  class latency_histogram
+  {
+  public:
+    // Records the duration (in seconds), as a whole number of picoseconds. Negative durations are recorded as zero.
+    void record(const double seconds)
+    {
+      const auto value = (seconds > 0.0) ? static_cast<std::uint64_t>(std::llround(seconds * 1e12)) : std::uint64_t{};
+      const std::size_t bucket_index = get_bucket_index(value);
+
+      if (bucket_index >= m_counts.size())
+      {
+        m_counts.resize(bucket_index + 1);
+      }
+      ++m_counts[bucket_index];
+      ++m_total_count;
+
+      if (value > m_max_value)
+      {
+        m_max_value = value;
+      }
+    }
+
+    std::uint64_t get_total_count() const
+    {
+      return m_total_count;
+    }
+
+    // The largest recorded duration, in seconds.
+    double get_max() const
+    {
+      return 1e-12 * static_cast<double>(m_max_value);
+    }
+
+    // The duration (in seconds) below which the specified fraction of the
+    // recorded durations is, for example 0.99 for p99, as the highest value
+    // of its bucket, like HdrHistogram does.
+    double get_percentile(const double fraction) const
+    {
+      const auto rank = static_cast<std::uint64_t>(std::ceil(fraction * static_cast<double>(m_total_count)));
+      std::uint64_t cumulative_count = 0;
+
+      for (std::size_t bucket_index = 0; bucket_index < m_counts.size(); ++bucket_index)
+      {
+        cumulative_count += m_counts[bucket_index];
+
+        if ((cumulative_count >= rank) && (cumulative_count > 0))
+        {
+          const std::uint64_t highest_value = get_highest_value_of_bucket(bucket_index);
+          return 1e-12 * static_cast<double>((highest_value < m_max_value) ? highest_value : m_max_value);
+        }
+      }
+      return get_max();
+    }
+
+  private:
+    static constexpr unsigned sub_bucket_bits = 7;
+
+    std::vector<std::uint64_t> m_counts;
+    std::uint64_t m_total_count = 0;
+    std::uint64_t m_max_value = 0;
+
+    // The values below 2^(sub_bucket_bits + 1) each have their own bucket.
+    // Beyond, each power of two is split into 2^sub_bucket_bits buckets.
+    static std::size_t get_bucket_index(const std::uint64_t value)
+    {
+      unsigned number_of_bits = 0;
+
+      while ((number_of_bits < 64) && ((value >> number_of_bits) != 0))
+      {
+        ++number_of_bits;
+      }
+      if (number_of_bits <= sub_bucket_bits + 1)
+      {
+        return static_cast<std::size_t>(value);
+      }
+      const unsigned shift = number_of_bits - (sub_bucket_bits + 1);
+      return (static_cast<std::size_t>(shift) << sub_bucket_bits) + static_cast<std::size_t>(value >> shift);
+    }
+
+    static std::uint64_t get_highest_value_of_bucket(const std::size_t bucket_index)
+    {
+      if (bucket_index < (std::size_t{ 2 } << sub_bucket_bits))
+      {
+        return bucket_index;
+      }
+      const auto shift = static_cast<unsigned>((bucket_index >> sub_bucket_bits) - 1);
+      const std::uint64_t lowest_value = static_cast<std::uint64_t>(bucket_index - (std::size_t{ shift } << sub_bucket_bits)) << shift;
+      return lowest_value + ((std::uint64_t{ 1 } << shift) - 1);
+    }
+  };
+
+}
+
+#endif
@@ -0,0 +1,396 @@
+#ifndef noexcept_benchmark_input_h
+#define noexcept_benchmark_input_h
+
+/*
+Copyright Niels Dekker, LKEB, Leiden University Medical Center
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0.txt
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Reads the results of a previous run, as written by write_json (from
+// noexcept_benchmark_output.h). The JSON parser is minimal, but it supports
+// any valid JSON text.
+
+#include "noexcept_benchmark_output.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <istream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+
+namespace noexcept_benchmark
+{
+  struct json_value
+  {
+    enum class type { null, boolean, number, string, array, object };
+
+    type value_type = type::null;
+    bool boolean = false;
+    double number = 0.0;
+    std::string string;
+
+    // The elements of an array, or the values of the members of an object.
+    std::vector<json_value> elements;
+
+    // The names of the members of an object.
+    std::vector<std::string> names;
+
+    // Returns the value of the member with the specified name, or a null value.
+    const json_value& operator[](const std::string& name) const
+    {
+      static const json_value null_value;
+
+      for (std::size_t i = 0; i < names.size(); ++i)
+      {
+        if (names[i] == name)
+        {
+          return elements[i];
+        }
+      }
+      return null_value;
+    }
+  };
+
+
+  class json_parser
+  {
+    const std::string& m_text;
+    std::size_t m_position = 0;
+    std::string m_error_message;
+
+    void skip_whitespace()
+    {
+      while ((m_position < m_text.size()) && (std::string(" \t\r\n").find(m_text[m_position]) != std::string::npos))
+      {
+        ++m_position;
+      }
+    }
+
+    bool fail(const std::string& message)
+    {
+      if (m_error_message.empty())
+      {
+        m_error_message = message + " at position " + std::to_string(m_position);
+      }
+      return false;
+    }
+
+    bool skip_literal(const char* const literal)
+    {
+      const std::string expected = literal;
+
+      if (m_text.compare(m_position, expected.size(), expected) != 0)
+      {
+        return fail("Expected \"" + expected + "\"");
+      }
+      m_position += expected.size();
+      return true;
+    }
+
+    bool parse_string(std::string& result)
+    {
+      if (!skip_literal("\""))
+      {
+        return false;
+      }
+      while (m_position < m_text.size())
+      {
+        const char c = m_text[m_position++];
+
+        if (c == '"')
+        {
+          return true;
+        }
+        if (c != '\\')
+        {
+          result += c;
+          continue;
+        }
+        if (m_position >= m_text.size())
+        {
+          break;
+        }
+        const char escaped = m_text[m_position++];
+
+        switch (escaped)
+        {
+        case 'b': result += '\b'; break;
+        case 'f': result += '\f'; break;
+        case 'n': result += '\n'; break;
+        case 'r': result += '\r'; break;
+        case 't': result += '\t'; break;
+        case 'u':
+        {
+          if (m_position + 4 > m_text.size())
+          {
+            return fail("Incomplete \\u escape sequence");
+          }
+          const auto code_point =
+            static_cast<unsigned>(std::strtoul(m_text.substr(m_position, 4).c_str(), nullptr, 16));
+          m_position += 4;
+
+          // Encodes the code point as UTF-8 (surrogate pairs are not combined).
+          if (code_point < 0x80)
+          {
+            result += static_cast<char>(code_point);
+          }
+          else if (code_point < 0x800)
+          {
+            result += static_cast<char>(0xC0 | (code_point >> 6));
+            result += static_cast<char>(0x80 | (code_point & 0x3F));
+          }
+          else
+          {
+            result += static_cast<char>(0xE0 | (code_point >> 12));
+            result += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+            result += static_cast<char>(0x80 | (code_point & 0x3F));
+          }
+          break;
+        }
+        default: result += escaped;
+        }
+      }
+      return fail("Unterminated string");
+    }
+
+    bool parse_value(json_value& result)
+    {
+      skip_whitespace();
+
+      if (m_position >= m_text.size())
+      {
+        return fail("Unexpected end of text");
+      }
+
+      switch (m_text[m_position])
+      {
+      case 'n':
+        result.value_type = json_value::type::null;
+        return skip_literal("null");
+      case 't':
+        result.value_type = json_value::type::boolean;
+        result.boolean = true;
+        return skip_literal("true");
+      case 'f':
+        result.value_type = json_value::type::boolean;
+        return skip_literal("false");
+      case '"':
+        result.value_type = json_value::type::string;
+        return parse_string(result.string);
+      case '[':
+        return parse_array(result);
+      case '{':
+        return parse_object(result);
+      default:
+      {
+        const char* const begin = m_text.c_str() + m_position;
+        char* end = nullptr;
+        result.value_type = json_value::type::number;
+        result.number = std::strtod(begin, &end);
+
+        if (end == begin)
+        {
+          return fail("Invalid value");
+        }
+        m_position += static_cast<std::size_t>(end - begin);
+        return true;
+      }
+      }
+    }
+
+    bool parse_array(json_value& result)
+    {
+      result.value_type = json_value::type::array;
+      ++m_position;
+      skip_whitespace();
+
+      if ((m_position < m_text.size()) && (m_text[m_position] == ']'))
+      {
+        ++m_position;
+        return true;
+      }
+      for (;;)
+      {
+        result.elements.emplace_back();
+
+        if (!parse_value(result.elements.back()))
+        {
+          return false;
+        }
+        skip_whitespace();
+
+        if ((m_position < m_text.size()) && (m_text[m_position] == ','))
+        {
+          ++m_position;
+          continue;
+        }
+        return skip_literal("]");
+      }
+    }
+
+    bool parse_object(json_value& result)
+    {
+      result.value_type = json_value::type::object;
+      ++m_position;
+      skip_whitespace();
+
+      if ((m_position < m_text.size()) && (m_text[m_position] == '}'))
+      {
+        ++m_position;
+        return true;
+      }
+      for (;;)
+      {
+        skip_whitespace();
+        result.names.emplace_back();
+        result.elements.emplace_back();
+
+        if (!parse_string(result.names.back()))
+        {
+          return false;
+        }
+        skip_whitespace();
+
+        if (!skip_literal(":") || !parse_value(result.elements.back()))
+        {
+          return false;
+        }
+        skip_whitespace();
+
+        if ((m_position < m_text.size()) && (m_text[m_position] == ','))
+        {
+          ++m_position;
+          continue;
+        }
+        return skip_literal("}");
+      }
+    }
+
+  public:
+    explicit json_parser(const std::string& text)
+      :
+      m_text(text)
+    {
+    }
+
+    bool parse(json_value& result)
+    {
+      if (!parse_value(result))
+      {
+        return false;
+      }
+      skip_whitespace();
+      return (m_position == m_text.size()) || fail("Unexpected text after the JSON value");
+    }
+
+    const std::string& get_error_message() const
+    {
+      return m_error_message;
+    }
+  };
+
+
+  inline variant_record to_variant_record(const json_value& value, const std::vector<std::string>& counter_names)
+  {
+    variant_record result;
+    result.code_size = static_cast<std::uint64_t>(value["code_size"].number);
+
+    const json_value& loop_vectorized = value["loop_vectorized"];
+    result.vectorization = (loop_vectorized.value_type != json_value::type::boolean) ? loop_vectorization::unknown :
+      loop_vectorized.boolean ? loop_vectorization::vectorized : loop_vectorization::not_vectorized;
+
+    for (const json_value& duration : value["durations"].elements)
+    {
+      result.durations.push_back(duration.number);
+    }
+    result.counter_values.resize(result.durations.size(), std::vector<std::int64_t>(counter_names.size()));
+
+    for (std::size_t counter_index = 0; counter_index < counter_names.size(); ++counter_index)
+    {
+      const std::vector<json_value>& values = value["counters"][counter_names[counter_index]].elements;
+
+      for (std::size_t sample_index = 0; (sample_index < values.size()) &&
+        (sample_index < result.durations.size()); ++sample_index)
+      {
+        result.counter_values[sample_index][counter_index] = static_cast<std::int64_t>(values[sample_index].number);
+      }
+    }
+    return result;
+  }
+
+
+  // Reads the test case records from JSON text, as written by write_json, and
+  // optionally its settings. Returns false (and an error message) when the
+  // text cannot be parsed.
+  inline bool read_json_records(std::istream& input, std::vector<test_case_record>& records,
+    std::string& error_message, name_value_pairs* const settings = nullptr)
+  {
+    const std::string text{ std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>() };
+    json_parser parser(text);
+    json_value root;
+
+    if (!parser.parse(root))
+    {
+      error_message = parser.get_error_message();
+      return false;
+    }
+    if (root["test_cases"].value_type != json_value::type::array)
+    {
+      error_message = "No \"test_cases\" array found";
+      return false;
+    }
+
+    if (settings != nullptr)
+    {
+      const json_value& settings_object = root["settings"];
+
+      for (std::size_t i = 0; i < settings_object.names.size(); ++i)
+      {
+        settings->emplace_back(settings_object.names[i], settings_object.elements[i].string);
+      }
+    }
+
+    for (const json_value& test_case : root["test_cases"].elements)
+    {
+      test_case_record record;
+      record.id = test_case["id"].string;
+      record.description = test_case["description"].string;
+      record.N = static_cast<unsigned>(test_case["N"].number);
+      record.bytes_per_N = static_cast<unsigned>(test_case["bytes_per_N"].number);
+
+      const json_value& variants = test_case["variants"];
+
+      for (const std::string& name : variants["noexcept"]["counters"].names)
+      {
+        record.counter_names.push_back(name);
+      }
+      record.noexcept_variant = to_variant_record(variants["noexcept"], record.counter_names);
+      record.implicit_variant = to_variant_record(variants["implicit"], record.counter_names);
+
+      if (record.noexcept_variant.durations.empty() ||
+        (record.noexcept_variant.durations.size() != record.implicit_variant.durations.size()))
+      {
+        error_message = "Missing or inconsistent durations of test case \"" + record.id + "\"";
+        return false;
+      }
+      records.push_back(record);
+    }
+    return true;
+  }
+
+}
+
+#endif
@@ -15,15 +15,42 @@ limitations under the License.
 */
 
 #include "noexcept_benchmark.h"
+#include "noexcept_benchmark_affinity.h"
+#include "noexcept_benchmark_cache.h"
+#include "noexcept_benchmark_code_size.h"
+#include "noexcept_benchmark_comparison.h"
+#include "noexcept_benchmark_counters.h"
+#include "noexcept_benchmark_environment.h"
+#include "noexcept_benchmark_histogram.h"
+#include "noexcept_benchmark_input.h"
+#include "noexcept_benchmark_lib_variants.h"
+#include "noexcept_benchmark_memory.h"
+#include "noexcept_benchmark_output.h"
+#include "noexcept_benchmark_pages.h"
+#include "noexcept_benchmark_plugin.h"
+#include "noexcept_benchmark_process.h"
+#include "noexcept_benchmark_statistics.h"
+#include "noexcept_benchmark_threads.h"
+#include "noexcept_benchmark_vectorization.h"
+#include "static_lib/static_lib.h"
 
 #include <algorithm>
 #include <chrono>
+#include <cerrno>
 #include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <initializer_list>
 #include <iomanip>
 #include <iostream>
 #include <limits>
+#include <memory>
+#include <numeric>
+#include <random>
 #include <sstream>
 #include <string>
+#include <vector>
 
 using namespace noexcept_benchmark;
 
@@ -31,9 +58,12 @@ using namespace noexcept_benchmark;
 
 namespace
 {
-  const int number_of_iterations = NOEXCEPT_BENCHMARK_NUMBER_OF_ITERATIONS;
   const std::streamsize output_precision = 8;
 
+  // Instead of an actual N (which is always positive): N is yet to be calibrated (--calibrate).
+  const unsigned N_to_be_calibrated = 0;
+  const double significance_level = 0.05;
+
   const unsigned column_gap_size = 2;
   const std::string column_gap(column_gap_size, ' ');
   const std::string indent(4, ' ');
@@ -55,291 +85,2328 @@ namespace
     return (x < y) ? '<' : (x > y) ? '>' : (x == y) ? '=' : ' ';
   }
 
-  template <unsigned N>
-  class test_result
+  // Estimates the duration of a CPU cycle, in seconds, by timing a chain of
+  // dependent increments, each of which takes one cycle on any modern CPU.
+  // Takes the median of a number of chains, after a discarded one that lets
+  // the CPU clock up, so that a single preempted or short chain (for example,
+  // measured across a frequency change) does not determine the estimate.
+  // Measured only once.
+  double get_seconds_per_cycle()
   {
-    unsigned m_number_of_times_noexcept_is_faster = 0;
-    unsigned m_number_of_times_implicit_is_faster = 0;
-    double m_sum_of_durations_noexcept = 0.0;
-    double m_sum_of_durations_implicit = 0.0;
-    double m_shortest_duration_noexcept = std::numeric_limits<double>::infinity();
-    double m_shortest_duration_implicit = std::numeric_limits<double>::infinity();
-    const char* const m_test_case_name;
+    static const double seconds_per_cycle = []
+    {
+      const unsigned number_of_increments = 1000000;
+      const int number_of_chains = 15;
+      std::vector<double> durations;
 
-  public:
+      for (int chain = -1; chain < number_of_chains; ++chain)
+      {
+        std::uint64_t value = 0;
+        const auto ticks1 = default_timer::start();
 
-    explicit test_result(const char* const test_case_name)
-      :
-      m_test_case_name{ test_case_name }
-    {
-      std::cout
-        << "\n"
-        << "["
+        for (unsigned i = 0; i < number_of_increments; ++i)
+        {
+          ++value;
+          do_not_optimize(value);
+        }
+        const auto ticks2 = default_timer::stop();
+
+        if (chain >= 0)
+        {
+          durations.push_back(static_cast<double>(ticks2 - ticks1));
+        }
+      }
+      return get_median(durations) * default_timer::get_seconds_per_tick() / number_of_increments;
+    }();
+    return seconds_per_cycle;
+  }
+
+  // Prints the description of a test case, followed by the column headers.
+  void print_test_case_header(std::ostream& output, const std::string& description, const unsigned N,
+    const char* const unit_label)
+  {
+    output
+      << "\n"
+      << "["
 #ifdef _MSC_VER
-        << "MSVC "
-        << (CHAR_BIT * sizeof(void*))
-        << "-bit"
+      << "MSVC "
+      << (CHAR_BIT * sizeof(void*))
+      << "-bit"
 #endif
 #ifdef __linux__
-        << "Linux "
+      << "Linux "
 #endif
 #ifdef __APPLE__
-        << "Apple "
+      << "Apple "
 #endif
 #ifdef __clang__
-        << "Clang"
+      << "Clang"
 #elif defined(__GNUC__)
-        << "GCC"
+      << "GCC"
 #endif
-        << "]"
+      << "]"
 #if NOEXCEPT_BENCHMARK_THROW_EXCEPTION
-        << "[`throw` included]"
+      << "[`throw` included]"
 #else
-        << "[`throw` excluded]"
+      << "[`throw` excluded]"
 #endif
-        << "[" << test_case_name << " (N = " << N
-        << ")]\n"
-        << indent
-        << "noexcept"
-        << std::string(output_precision + 3 - sizeof("noexcept"), ' ')
-        << std::string(2 * column_gap_size + 1, ' ')
-        << "implicit"
-        << std::string(output_precision + 3 - sizeof("implicit"), ' ')
-        << column_gap
-        << "(durations in seconds)"
-        << std::flush;
+      << "[" << description << " (N = " << N
+      << ")]\n"
+      << indent
+      << "noexcept"
+      << std::string(output_precision + 3 - sizeof("noexcept"), ' ')
+      << std::string(2 * column_gap_size + 1, ' ')
+      << "implicit"
+      << std::string(output_precision + 3 - sizeof("implicit"), ' ')
+      << column_gap
+      << "(" << unit_label << ")"
+      << std::flush;
+  }
+
+
+  class test_result
+  {
+    std::ostream& m_output;
+    test_case_record m_record;
+    const bool m_is_N_calls;
+
+    std::vector<double> get_counter_values(
+      const variant_record& variant,
+      const std::string& counter_name) const
+    {
+      const auto counter_index = static_cast<std::size_t>(std::find(m_record.counter_names.cbegin(),
+        m_record.counter_names.cend(), counter_name) - m_record.counter_names.cbegin());
+      std::vector<double> result;
+
+      for (const std::vector<std::int64_t>& values : variant.counter_values)
+      {
+        result.push_back(static_cast<double>(values.at(counter_index)));
+      }
+      return result;
     }
 
-    void update_test_result(const durations_type& durations)
+    bool has_counter(const std::string& counter_name) const
     {
-      m_sum_of_durations_noexcept += durations.duration_noexcept;
-      m_sum_of_durations_implicit += durations.duration_implicit;
+      return std::find(m_record.counter_names.cbegin(), m_record.counter_names.cend(), counter_name) !=
+        m_record.counter_names.cend();
+    }
 
-      m_shortest_duration_noexcept = std::min(m_shortest_duration_noexcept, durations.duration_noexcept);
-      m_shortest_duration_implicit = std::min(m_shortest_duration_implicit, durations.duration_implicit);
+    // Prints the medians of the counter values, and the medians of the ratios
+    // between two counters, like instructions per cycle (IPC).
+    void print_counter_rows() const
+    {
+      m_output
+        << '\n'
+        << indent
+        << "(counters, medians per sample)"
+        << std::setprecision(0);
 
-      if (durations.duration_noexcept < durations.duration_implicit)
+      for (const std::string& counter_name : m_record.counter_names)
       {
-        ++m_number_of_times_noexcept_is_faster;
+        print_row(
+          get_median(get_counter_values(m_record.noexcept_variant, counter_name)),
+          get_median(get_counter_values(m_record.implicit_variant, counter_name)),
+          counter_name.c_str());
       }
-      if (durations.duration_implicit < durations.duration_noexcept)
+      m_output << std::setprecision(4);
+
+      const auto print_ratio_row = [this](const char* const numerator, const char* const denominator,
+        const char* const label)
       {
-        ++m_number_of_times_implicit_is_faster;
-      }
+        if (has_counter(numerator) && has_counter(denominator))
+        {
+          const auto get_median_ratio = [this, numerator, denominator](const variant_record& variant)
+          {
+            const std::vector<double> numerators = get_counter_values(variant, numerator);
+            const std::vector<double> denominators = get_counter_values(variant, denominator);
+            std::vector<double> ratios;
+
+            for (std::size_t i = 0; i < numerators.size(); ++i)
+            {
+              ratios.push_back(divide_by_positive(numerators[i], denominators[i]));
+            }
+            return get_median(ratios);
+          };
+          print_row(get_median_ratio(m_record.noexcept_variant), get_median_ratio(m_record.implicit_variant), label);
+        }
+      };
+      print_ratio_row("instructions", "cycles", "IPC, instructions per cycle");
+      print_ratio_row("branch-misses", "branches", "branch-miss rate");
+      print_ratio_row("branch-misses", "instructions", "branch-misses per instruction");
+      m_output << std::setprecision(output_precision);
     }
 
-    ~test_result()
+    void print_code_size_row() const
     {
-      const std::string dashes(output_precision + 2, '-');
+      m_output << std::setprecision(0);
+      print_row(static_cast<double>(m_record.noexcept_variant.code_size),
+        static_cast<double>(m_record.implicit_variant.code_size), "code sizes of the test functions, in bytes");
+      m_output << std::setprecision(output_precision);
+    }
 
-      std::cout
-        << '\n'
-        << indent
-        << dashes
-        << std::string(2 * column_gap_size + 1, ' ')
-        << dashes
+    void print_row(const double value_noexcept, const double value_implicit, const char* const label) const
+    {
+      const auto width = static_cast<int>(output_precision + 2);
+
+      m_output
         << '\n'
         << indent
-        << m_sum_of_durations_noexcept
+        << std::setw(width)
+        << value_noexcept
         << column_gap
-        << get_comparison_char(m_sum_of_durations_noexcept, m_sum_of_durations_implicit)
+        << get_comparison_char(value_noexcept, value_implicit)
         << column_gap
-        << m_sum_of_durations_implicit
+        << std::setw(width)
+        << value_implicit
         << column_gap
-        << "(sum of durations)\n"
+        << "(" << label << ")";
+    }
+
+  public:
+
+    test_result(std::ostream& output, const std::string& id, const std::string& description, const unsigned N,
+      const unsigned bytes_per_N, const bool is_N_calls, const std::vector<std::string>& counter_names = {})
+      :
+      m_output(output),
+      m_record{ id, description, N, bytes_per_N, counter_names, {}, {} },
+      m_is_N_calls{ is_N_calls }
+    {
+      print_test_case_header(m_output, description, N, "durations in seconds");
+    }
+
+    const test_case_record& get_record() const
+    {
+      return m_record;
+    }
+
+    void set_code_sizes(const std::uint64_t code_size_noexcept, const std::uint64_t code_size_implicit)
+    {
+      m_record.noexcept_variant.code_size = code_size_noexcept;
+      m_record.implicit_variant.code_size = code_size_implicit;
+    }
+
+    void set_loop_vectorizations(const loop_vectorization vectorization_noexcept,
+      const loop_vectorization vectorization_implicit)
+    {
+      m_record.noexcept_variant.vectorization = vectorization_noexcept;
+      m_record.implicit_variant.vectorization = vectorization_implicit;
+    }
+
+    void update_test_result(const durations_type& durations)
+    {
+      m_record.noexcept_variant.durations.push_back(durations.duration_noexcept);
+      m_record.implicit_variant.durations.push_back(durations.duration_implicit);
+    }
+
+    void update_counter_values(
+      const std::vector<std::int64_t>& counter_values_noexcept,
+      const std::vector<std::int64_t>& counter_values_implicit)
+    {
+      m_record.noexcept_variant.counter_values.push_back(counter_values_noexcept);
+      m_record.implicit_variant.counter_values.push_back(counter_values_implicit);
+    }
+
+    void update_test_result_and_print_durations(const durations_type& durations)
+    {
+      update_test_result(durations);
+      m_output
+        << '\n'
         << indent
-        << m_shortest_duration_noexcept
-        << column_gap
-        << get_comparison_char(m_shortest_duration_noexcept, m_shortest_duration_implicit)
+        << durations.duration_noexcept
         << column_gap
-        << m_shortest_duration_implicit
+        << get_comparison_char(durations.duration_noexcept, durations.duration_implicit)
         << column_gap
-        << "(shortest durations)"
+        << durations.duration_implicit
+        << std::flush;
+    }
+
+    ~test_result()
+    {
+      const std::vector<double>& durations_noexcept = m_record.noexcept_variant.durations;
+      const std::vector<double>& durations_implicit = m_record.implicit_variant.durations;
+
+      if (durations_noexcept.empty())
+      {
+        m_output << std::endl;
+        return;
+      }
+
+      const std::string dashes(output_precision + 2, '-');
+      const sample_summary summary_noexcept = get_sample_summary(durations_noexcept);
+      const sample_summary summary_implicit = get_sample_summary(durations_implicit);
+      const ratio_comparison comparison = get_ratio_comparison(durations_implicit, durations_noexcept);
+
+      m_output
+        << '\n'
+        << indent
+        << dashes
+        << std::string(2 * column_gap_size + 1, ' ')
+        << dashes;
+      print_row(summary_noexcept.sum, summary_implicit.sum, "sum of durations");
+      print_row(summary_noexcept.minimum, summary_implicit.minimum, "shortest durations");
+      print_row(summary_noexcept.median, summary_implicit.median, "medians");
+      print_row(1e9 * summary_noexcept.median / m_record.N, 1e9 * summary_implicit.median / m_record.N,
+        "medians per N, in nanoseconds");
+
+      if (m_record.bytes_per_N > 0)
+      {
+        const double bytes = static_cast<double>(m_record.bytes_per_N) * m_record.N;
+        print_row(1e-9 * divide_by_positive(bytes, summary_noexcept.median),
+          1e-9 * divide_by_positive(bytes, summary_implicit.median),
+          "throughput of the medians, in GB/s");
+      }
+      print_row(summary_noexcept.percentile25, summary_implicit.percentile25, "25th percentiles");
+      print_row(summary_noexcept.percentile75, summary_implicit.percentile75, "75th percentiles");
+      print_row(summary_noexcept.median_absolute_deviation, summary_implicit.median_absolute_deviation,
+        "median absolute deviations");
+
+      if (m_record.noexcept_variant.code_size > 0)
+      {
+        print_code_size_row();
+      }
+
+      if (!m_record.noexcept_variant.counter_values.empty())
+      {
+        print_counter_rows();
+      }
+
+      if ((m_record.noexcept_variant.vectorization != loop_vectorization::unknown) ||
+        (m_record.implicit_variant.vectorization != loop_vectorization::unknown))
+      {
+        m_output
+          << "\nKernel loop, according to the compiler report: "
+          << to_string(m_record.noexcept_variant.vectorization)
+          << " (noexcept), "
+          << to_string(m_record.implicit_variant.vectorization)
+          << " (implicit)";
+      }
+
+      // A call (as opposed to an element of data) should take at least a cycle.
+      const double shortest_median_per_N = std::min(summary_noexcept.median, summary_implicit.median) / m_record.N;
+
+      if (m_is_N_calls && (shortest_median_per_N < get_seconds_per_cycle()))
+      {
+        m_output
+          << std::setprecision(2)
+          << "\nWarning: a median per N ("
+          << 1e9 * shortest_median_per_N
+          << " ns) is less than a CPU cycle (about "
+          << 1e9 * get_seconds_per_cycle()
+          << " ns), so the compiler may have optimized away (part of) the test!";
+      }
+
+      m_output
         << std::setprecision(2)
         << "\nRatio sum of durations implicit/noexcept: "
-        << divide_by_positive(m_sum_of_durations_implicit, m_sum_of_durations_noexcept)
+        << divide_by_positive(summary_implicit.sum, summary_noexcept.sum)
+        << "\nRatio medians implicit/noexcept: "
+        << comparison.ratio_of_medians
+        << " (95% bootstrap confidence interval: "
+        << comparison.ratio_interval.lower
+        << " - "
+        << comparison.ratio_interval.upper
+        << ")"
+        << std::setprecision(4)
+        << "\nMann-Whitney U test: p = "
+        << comparison.p_value
         << std::setprecision(output_precision)
-        << ((m_number_of_times_noexcept_is_faster == number_of_iterations) ?
-          "\nIn this case, 'noexcept' specifications always appear faster." : "")
-        << ((m_number_of_times_implicit_is_faster == number_of_iterations) ?
-          "\nIn this case, implicit exception specifications always appear faster." : "")
-        << (((m_number_of_times_noexcept_is_faster < number_of_iterations) &&
-            (m_number_of_times_implicit_is_faster < number_of_iterations)) ?
-          "\nIn this case, neither implicit nor noexcept specifications always appear faster." : "")
+        << ((comparison.p_value < significance_level) ?
+          ((summary_noexcept.median < summary_implicit.median) ?
+            "\nIn this case, 'noexcept' specifications appear significantly faster (p < 0.05)." :
+            "\nIn this case, implicit exception specifications appear significantly faster (p < 0.05).") :
+          "\nIn this case, there is no significant difference between implicit and noexcept specifications.")
         << std::endl;
     }
   };
 
 
-  template <typename T1, typename T2>
-  durations_type profile_func_calls(T1 func1, T2 func2)
+  // The exported_func calls must be done from outside the libs, to measure calls
+  // across the shared library boundary.
+  double test_noexcept_exported_func(const unsigned number_of_func_calls)
   {
-    durations_type durations;
-    durations.duration_noexcept = profile_func_call(func1);
-    durations.duration_implicit = profile_func_call(func2);
-    return durations;
+    return profile_func_call([number_of_func_calls]
+    {
+      bool do_throw_exception = false;
+
+      for (unsigned i = 0; i < number_of_func_calls; ++i)
+      {
+        noexcept_benchmark::do_not_optimize(do_throw_exception);
+        noexcept_lib::exported_func(do_throw_exception);
+      }
+    });
   }
 
-  template <unsigned N>
-  void update_test_result_and_print_durations(
-    test_result<N>& result,
-    const durations_type& durations)
+  double test_implicit_exported_func(const unsigned number_of_func_calls)
   {
-    result.update_test_result(durations);
-    std::cout
-      << '\n'
-      << indent
-      << durations.duration_noexcept
-      << column_gap
-      << get_comparison_char(durations.duration_noexcept, durations.duration_implicit)
-      << column_gap
-      << durations.duration_implicit
-      << std::flush;
+    return profile_func_call([number_of_func_calls]
+    {
+      bool do_throw_exception = false;
+
+      for (unsigned i = 0; i < number_of_func_calls; ++i)
+      {
+        noexcept_benchmark::do_not_optimize(do_throw_exception);
+        implicit_lib::exported_func(do_throw_exception);
+      }
+    });
   }
 
-}
 
-int main()
-{
-  std::cout
-    << std::fixed
-    << std::setprecision(output_precision)
-    << "The noexcept benchmark from https://github.com/N-Dekker/noexcept_benchmark"
-    << "\n__FILE__ = " << __FILE__
-    << "\nsizeof(void*) = " << sizeof(void*)
-    << " (" << CHAR_BIT * sizeof(void*) << "-bit)"
-    << "\n__DATE__ = " << __DATE__
-    << "\n__TIME__ = " << __TIME__
-#ifdef __VERSION__
-    << "\n__VERSION__ = "
-    __VERSION__
-#endif
-#ifdef _MSC_FULL_VER
-    << "\n_MSC_FULL_VER = "
-    << _MSC_FULL_VER
-#endif
-#ifdef _MSC_BUILD
-    << "\n_MSC_BUILD = "
-    << _MSC_BUILD
-#endif
-#ifdef _DEBUG
-    << "\n_DEBUG"
-#endif
-#ifdef NDEBUG
-    << "\nNDEBUG (\"Not Debug\")"
-#endif
-    << "\nNOEXCEPT_BENCHMARK_NUMBER_OF_ITERATIONS = "
-    << NOEXCEPT_BENCHMARK_NUMBER_OF_ITERATIONS
-    << "\nNOEXCEPT_BENCHMARK_THROW_EXCEPTION = "
-    << NOEXCEPT_BENCHMARK_THROW_EXCEPTION
-#if NOEXCEPT_BENCHMARK_THROW_EXCEPTION
-    << " (`throw exception{}` included by #if)"
-#else
-    << " (`throw exception{}` excluded by #if)"
-#endif
-    << std::endl;
+  // The functions that each lib exports, besides its test functions.
+  struct lib_functions
+  {
+    void (*exported_func)(bool);
+    void (*set_sample_hooks)(const sample_hooks*);
+    void (*set_timer_calibration)(const char*, double, unsigned);
+    void (*set_throw_path_parameters)(unsigned, unsigned, unsigned);
+    void (*set_memory_placement)(unsigned, unsigned, unsigned);
+    const move_audit_entry* (*get_move_audit)(unsigned);
+    const lib_test_case* (*get_test_cases)();
+  };
+
+  // A noexcept lib and an implicit lib, built by the same compiler options.
+  struct lib_variant
   {
-    test_result<NOEXCEPT_BENCHMARK_NUMBER_OF_INLINE_FUNC_CALLS> result(
-      "inline function calls");
+    std::string name;
+    std::string compile_options;
+    lib_functions noexcept_lib;
+    lib_functions implicit_lib;
+  };
+
+  // The default libs (whose name is empty), followed by the variants from
+  // NOEXCEPT_BENCHMARK_LIB_VARIANTS, and those that are added by --plugin.
+  std::vector<lib_variant>& get_lib_variants()
+  {
+#define NOEXCEPT_BENCHMARK_GET_LIB_FUNCTIONS(lib) \
+    { lib::exported_func, lib::set_sample_hooks, lib::set_timer_calibration, lib::set_throw_path_parameters, \
+      lib::set_memory_placement, lib::get_move_audit, lib::get_test_cases }
+#define NOEXCEPT_BENCHMARK_REGISTER_LIB_VARIANT(name, compile_options) \
+      { #name, compile_options, \
+      NOEXCEPT_BENCHMARK_GET_LIB_FUNCTIONS(noexcept_lib_##name), NOEXCEPT_BENCHMARK_GET_LIB_FUNCTIONS(implicit_lib_##name) },
 
-    for (int iteration_number = 0; iteration_number < number_of_iterations; ++iteration_number)
+    static std::vector<lib_variant> lib_variants
     {
-      durations_type durations;
-      durations.duration_noexcept = noexcept_lib::test_inline_func();
-      durations.duration_implicit = implicit_lib::test_inline_func();
-      update_test_result_and_print_durations(result, durations);
-    }
+      { "", "", NOEXCEPT_BENCHMARK_GET_LIB_FUNCTIONS(noexcept_lib), NOEXCEPT_BENCHMARK_GET_LIB_FUNCTIONS(implicit_lib) },
+      NOEXCEPT_BENCHMARK_LIB_VARIANTS(NOEXCEPT_BENCHMARK_REGISTER_LIB_VARIANT)
+    };
+
+#undef NOEXCEPT_BENCHMARK_REGISTER_LIB_VARIANT
+#undef NOEXCEPT_BENCHMARK_GET_LIB_FUNCTIONS
+    return lib_variants;
+  }
+
+
+  lib_functions get_lib_functions(const lib_descriptor& descriptor)
+  {
+    return { descriptor.exported_func, descriptor.set_sample_hooks, descriptor.set_timer_calibration,
+      descriptor.set_throw_path_parameters, descriptor.set_memory_placement, descriptor.get_move_audit,
+      descriptor.get_test_cases };
   }
+
+  // Loads the libs of --plugin=NAME=NOEXCEPT_LIB,IMPLICIT_LIB, and adds them as a lib variant.
+  bool add_plugin_lib_variant(const std::string& plugin, std::string& error_message)
   {
-    test_result<NOEXCEPT_BENCHMARK_NUMBER_OF_EXPORTED_FUNC_CALLS> result(
-      "exported library function calls");
+    static std::vector<std::unique_ptr<plugin_lib>> plugin_libs;
 
-    for (int iteration_number = 0; iteration_number < number_of_iterations; ++iteration_number)
+    const std::size_t equal_sign_position = plugin.find('=');
+    const std::size_t comma_position = plugin.find(',', equal_sign_position);
+
+    if ((equal_sign_position == 0) || (equal_sign_position == std::string::npos) ||
+      (comma_position == std::string::npos))
     {
-      enum { number_of_func_calls = NOEXCEPT_BENCHMARK_NUMBER_OF_EXPORTED_FUNC_CALLS };
+      error_message = "Expected NAME=NOEXCEPT_LIB,IMPLICIT_LIB";
+      return false;
+    }
+    const std::string name = plugin.substr(0, equal_sign_position);
 
-      update_test_result_and_print_durations(result, profile_func_calls(
-        []
+    for (const lib_variant& variant : get_lib_variants())
+    {
+      if (variant.name == name)
       {
-        volatile bool do_throw_exception = noexcept_benchmark::get_false();
+        error_message = "There is already a lib variant named \"" + name + "\"";
+        return false;
+      }
+    }
 
-        for (int i = 0; i < number_of_func_calls; ++i)
-        {
-          noexcept_lib::exported_func(do_throw_exception);
-        }
+    const lib_descriptor* descriptors[2] = {};
+    const std::string file_names[2] =
+    {
+      plugin.substr(equal_sign_position + 1, comma_position - equal_sign_position - 1),
+      plugin.substr(comma_position + 1)
+    };
+
+    for (int i = 0; i < 2; ++i)
+    {
+      plugin_libs.emplace_back(new plugin_lib(file_names[i]));
+      descriptors[i] = plugin_libs.back()->get_descriptor();
+
+      if (descriptors[i] == nullptr)
+      {
+        error_message = plugin_libs.back()->get_error_message();
+        return false;
+      }
+      if ((descriptors[i]->is_noexcept != 0) != (i == 0))
+      {
+        error_message = "\"" + file_names[i] + "\" is " + ((i == 0) ? "not a noexcept lib" : "not an implicit lib");
+        return false;
+      }
+    }
+
+    const std::string compiler = descriptors[0]->compiler;
+    get_lib_variants().push_back({ name,
+      (compiler == descriptors[1]->compiler) ? compiler : (compiler + ", " + descriptors[1]->compiler),
+      get_lib_functions(*descriptors[0]), get_lib_functions(*descriptors[1]) });
+    return true;
+  }
+
+
+  struct test_case
+  {
+    std::string id;
+    std::string description;
+    unsigned min_N;
+    unsigned default_N;
+    unsigned max_N;
+    unsigned bytes_per_N;
+
+    // Whether N is a number of calls (or frames), rather than a number of elements.
+    bool is_N_calls;
+    double (*func_noexcept)(unsigned);
+    double (*func_implicit)(unsigned);
+  };
+
+  // Omits the "test_" prefix from the name of a test function.
+  std::string get_test_case_id(const std::string& func_name)
+  {
+    const std::string prefix = "test_";
+    return (func_name.compare(0, prefix.size(), prefix) == 0) ?
+      func_name.substr(prefix.size()) : func_name;
+  }
+
+  // Finds the test function with the specified test case id, or returns null.
+  double (*find_lib_test_function(const lib_test_case* lib_test_cases, const std::string& id))(unsigned)
+  {
+    for (; lib_test_cases->func_name != nullptr; ++lib_test_cases)
+    {
+      if (get_test_case_id(lib_test_cases->func_name) == id)
+      {
+        return lib_test_cases->func;
+      }
+    }
+    return nullptr;
+  }
+
+  // The test cases of the default libs. Each of them is followed by the same
+  // test case of each lib variant (if any), like "vector_reserve/O2".
+  std::vector<test_case> get_registered_test_cases()
+  {
+    std::vector<test_case> default_test_cases
+    {
+#define NOEXCEPT_BENCHMARK_REGISTER_TEST_CASE(func, description, min_N, default_N, max_N, bytes_per_N, is_N_calls) \
+      { get_test_case_id(#func), description, min_N, default_N, max_N, bytes_per_N, is_N_calls != 0, \
+        noexcept_lib::func, implicit_lib::func },
+      NOEXCEPT_BENCHMARK_LIB_TEST_CASES(NOEXCEPT_BENCHMARK_REGISTER_TEST_CASE)
+#undef NOEXCEPT_BENCHMARK_REGISTER_TEST_CASE
+    };
+
+    // The calls from outside the libs. As before the test case registry, they
+    // directly follow inline_func, so that the output still lines up with the
+    // output of earlier runs.
+    const std::vector<test_case> call_test_cases
+    {
+      {
+        "exported_func",
+        "exported library function calls",
+        1,
+        NOEXCEPT_BENCHMARK_NUMBER_OF_EXPORTED_FUNC_CALLS,
+        INT_MAX,
+        0,
+        true,
+        test_noexcept_exported_func,
+        test_implicit_exported_func
       },
-        []
+#define NOEXCEPT_BENCHMARK_REGISTER_STATIC_LIB_TEST_CASES(lib, lib_description) \
+      { #lib "_call", "direct calls of a function, in a " lib_description, \
+        1, NOEXCEPT_BENCHMARK_NUMBER_OF_EXPORTED_FUNC_CALLS, INT_MAX, 0, true, \
+        noexcept_##lib::test_call, implicit_##lib::test_call }, \
+      { #lib "_func_pointer_call", "function pointer calls, in a " lib_description, \
+        1, NOEXCEPT_BENCHMARK_NUMBER_OF_EXPORTED_FUNC_CALLS, INT_MAX, 0, true, \
+        noexcept_##lib::test_func_pointer_call, implicit_##lib::test_func_pointer_call }, \
+      { #lib "_virtual_call", "virtual function calls, in a " lib_description, \
+        1, NOEXCEPT_BENCHMARK_NUMBER_OF_EXPORTED_FUNC_CALLS, INT_MAX, 0, true, \
+        noexcept_##lib::test_virtual_call, implicit_##lib::test_virtual_call },
+      NOEXCEPT_BENCHMARK_STATIC_LIBS(NOEXCEPT_BENCHMARK_REGISTER_STATIC_LIB_TEST_CASES)
+#undef NOEXCEPT_BENCHMARK_REGISTER_STATIC_LIB_TEST_CASES
+    };
+
+    const auto inline_func_test_case = std::find_if(default_test_cases.cbegin(), default_test_cases.cend(),
+      [](const test_case& test) { return test.id == "inline_func"; });
+    default_test_cases.insert(
+      (inline_func_test_case == default_test_cases.cend()) ? inline_func_test_case : inline_func_test_case + 1,
+      call_test_cases.cbegin(), call_test_cases.cend());
+
+    std::vector<test_case> result;
+
+    for (const test_case& test : default_test_cases)
+    {
+      result.push_back(test);
+
+      for (const lib_variant& variant : get_lib_variants())
       {
-        volatile bool do_throw_exception = noexcept_benchmark::get_false();
+        const auto func_noexcept = find_lib_test_function(variant.noexcept_lib.get_test_cases(), test.id);
+        const auto func_implicit = find_lib_test_function(variant.implicit_lib.get_test_cases(), test.id);
 
-        for (int i = 0; i < number_of_func_calls; ++i)
+        if (!variant.name.empty() && (func_noexcept != nullptr) && (func_implicit != nullptr))
         {
-          implicit_lib::exported_func(do_throw_exception);
+          test_case variant_test = test;
+          variant_test.id += '/' + variant.name;
+          variant_test.description += ", " + variant.name + " variant (" + variant.compile_options + ")";
+          variant_test.func_noexcept = func_noexcept;
+          variant_test.func_implicit = func_implicit;
+          result.push_back(variant_test);
         }
-      }));
+      }
     }
+    return result;
   }
-  {
-    test_result<NOEXCEPT_BENCHMARK_NUMBER_OF_CATCHING_RECURSIVE_FUNC_CALLS> result(
-      "catching function calls");
 
-    for (int iteration_number = 0; iteration_number < number_of_iterations; ++iteration_number)
+
+  // Matches the text against a wildcard pattern, supporting '*' and '?'.
+  bool is_wildcard_match(const char* text, const char* pattern)
+  {
+    if (*pattern == '*')
+    {
+      return is_wildcard_match(text, pattern + 1) ||
+        ((*text != '\0') && is_wildcard_match(text + 1, pattern));
+    }
+    if (*text == '\0')
     {
-      durations_type durations;
-      durations.duration_noexcept = noexcept_lib::catching_func();
-      durations.duration_implicit = implicit_lib::catching_func();
-      update_test_result_and_print_durations(result, durations);
+      return *pattern == '\0';
     }
+    return ((*pattern == '?') || (*pattern == *text)) &&
+      is_wildcard_match(text + 1, pattern + 1);
   }
+
+  // The filter is a comma separated list of wildcard patterns. A test case is
+  // selected when any of the patterns matches either its id or its description.
+  bool is_selected_by_filter(const test_case& test, const std::string& filter)
   {
-    test_result<NOEXCEPT_BENCHMARK_INC_AND_DEC_FUNC_CALLS> result(
-      "inc `++` and dec `--`");
+    std::istringstream patterns{ filter };
+    std::string pattern;
 
-    for (int iteration_number = 0; iteration_number < number_of_iterations; ++iteration_number)
+    while (std::getline(patterns, pattern, ','))
     {
-      durations_type durations;
-      durations.duration_noexcept = noexcept_lib::test_inc_and_dec();
-      durations.duration_implicit = implicit_lib::test_inc_and_dec();
-      update_test_result_and_print_durations(result, durations);
+      if (is_wildcard_match(test.id.c_str(), pattern.c_str()) ||
+        is_wildcard_match(test.description.c_str(), pattern.c_str()))
+      {
+        return true;
+      }
     }
+    return false;
+  }
+
+
+  const shared_lib_code_size& get_code_size(const lib_functions& lib)
+  {
+    return get_shared_lib_code_size(reinterpret_cast<const void*>(lib.exported_func));
+  }
+
+  std::string get_lib_name(const char* const lib, const lib_variant& variant)
+  {
+    return variant.name.empty() ? lib : (lib + ('_' + variant.name));
   }
+
+
+  // The section sizes of all libs, as name/value pairs, like "noexcept_lib.text_bytes".
+  name_value_pairs get_code_size_environment()
   {
-    test_result<NOEXCEPT_BENCHMARK_STACK_UNWINDING_FUNC_CALLS> result(
-      "recursive stack unwinding");
+    name_value_pairs result;
 
-    for (int iteration_number = 0; iteration_number < number_of_iterations; ++iteration_number)
+    for (const lib_variant& variant : get_lib_variants())
     {
-      durations_type durations;
-      durations.duration_noexcept = noexcept_lib::test_stack_unwinding();
-      durations.duration_implicit = implicit_lib::test_stack_unwinding();
-      update_test_result_and_print_durations(result, durations);
+      for (const auto& lib : { std::make_pair("noexcept_lib", &variant.noexcept_lib),
+        std::make_pair("implicit_lib", &variant.implicit_lib) })
+      {
+        for (const auto& section_size : get_code_size(*lib.second).get_section_sizes())
+        {
+          result.emplace_back(get_lib_name(lib.first, variant) + section_size.first + "_bytes",
+            std::to_string(section_size.second));
+        }
+      }
     }
+    return result;
   }
+
+
+  // Prints the section sizes of the noexcept and the implicit lib of the variant, in bytes, side by side.
+  void print_code_sizes(std::ostream& output, const lib_variant& variant)
   {
-    test_result<NOEXCEPT_BENCHMARK_STACK_UNWINDING_OBJECTS> result(
-      "stack unwinding array");
+    const shared_lib_code_size::section_sizes_type& noexcept_sizes = get_code_size(variant.noexcept_lib).get_section_sizes();
+    const shared_lib_code_size::section_sizes_type& implicit_sizes = get_code_size(variant.implicit_lib).get_section_sizes();
+
+    if (noexcept_sizes.empty())
+    {
+      output << "\nCode size = unknown";
+      return;
+    }
+    output << "\nCode size, in bytes (" << get_lib_name("noexcept_lib", variant) << ", "
+      << get_lib_name("implicit_lib", variant) << "):";
 
-    for (int iteration_number = 0; iteration_number < number_of_iterations; ++iteration_number)
+    for (const auto& noexcept_size : noexcept_sizes)
     {
-      durations_type durations;
-      durations.duration_noexcept = noexcept_lib::test_stack_unwinding_array();
-      durations.duration_implicit = implicit_lib::test_stack_unwinding_array();
-      update_test_result_and_print_durations(result, durations);
+      const auto implicit_size = std::find_if(implicit_sizes.cbegin(), implicit_sizes.cend(),
+        [&noexcept_size](const std::pair<std::string, std::uint64_t>& size)
+      {
+        return size.first == noexcept_size.first;
+      });
+
+      output << "\n" << indent << noexcept_size.first << " = " << noexcept_size.second << ", "
+        << ((implicit_size == implicit_sizes.cend()) ? std::string("none") : std::to_string(implicit_size->second));
     }
   }
+
+
+  struct benchmark_options
+  {
+    std::string filter = "*";
+    int number_of_iterations = NOEXCEPT_BENCHMARK_NUMBER_OF_ITERATIONS;
+    bool calibrate = false;
+    double target_sample_duration = 0.05;
+    double confidence_interval_width = 0.0;
+    double time_budget = 60.0;
+    std::string counter_names;
+    const hardware_counters* counters = nullptr;
+    bool measure_memory = false;
+    const memory_sampler* memory = nullptr;
+    std::string format = "text";
+    std::string output_file_name;
+    std::string baseline_file_name;
+    double threshold = 0.05;
+    std::string order = "fixed";
+    unsigned seed = 0;
+    int number_of_warmups = 0;
+    int cpu_index = -1;
+    unsigned number_of_threads = 1;
+    unsigned throw_path_depth = NOEXCEPT_BENCHMARK_THROW_PATH_DEPTH;
+    unsigned throw_path_locals_per_frame = NOEXCEPT_BENCHMARK_THROW_PATH_LOCALS_PER_FRAME;
+    unsigned throw_path_exception_size = NOEXCEPT_BENCHMARK_THROW_PATH_EXCEPTION_SIZE;
+
+    // For vector_reserve: none, transparent or explicit huge pages, and default, local or interleave NUMA placement.
+    std::string huge_pages = "none";
+    std::string numa = "default";
+    bool prefault = false;
+
+    // When not zero, the latencies of this number of batches are measured, per test case, instead of its durations.
+    unsigned number_of_latency_batches = 0;
+    unsigned batch_size = 100;
+
+    // When not zero, the test cases are run on a thread with a stack of this size (in bytes).
+    std::size_t stack_size = 0;
+    bool sweep = false;
+
+    // When not empty, each test case is run with each of these N values.
+    std::vector<unsigned> N_values;
+
+    // With --isolate, each test case is run in a child process, which has the
+    // (internal) option --isolated-test=ID.
+    bool isolate = false;
+    std::string isolated_test_id;
+    bool high_priority = false;
+
+    // When not empty, the records are read from (and written to) the result cache in this directory.
+    std::string cache_dir;
+    bool force = false;
+
+    // With --audit, the copy and move operations of the elements of standard operations are printed, instead.
+    bool audit = false;
+  };
+
+
+  // An isolated child process only runs the test case whose id is specified by --isolated-test.
+  bool is_selected(const test_case& test, const benchmark_options& options)
+  {
+    return options.isolated_test_id.empty() ?
+      is_selected_by_filter(test, options.filter) : (test.id == options.isolated_test_id);
+  }
+
+
+  memory_placement to_memory_placement(const benchmark_options& options)
+  {
+    memory_placement placement;
+    placement.huge_pages = (options.huge_pages == "transparent") ? huge_page_mode::transparent :
+      (options.huge_pages == "explicit") ? huge_page_mode::explicit_huge_pages : huge_page_mode::none;
+    placement.numa = (options.numa == "local") ? numa_placement::local :
+      (options.numa == "interleave") ? numa_placement::interleave : numa_placement::first_touch;
+    placement.prefault = options.prefault;
+    return placement;
+  }
+
+
+  std::string to_short_string(const double value)
+  {
+    std::ostringstream stream;
+    stream << value;
+    return stream.str();
+  }
+
+
+  // The names of the hardware counters, followed by those of the memory statistics, if any.
+  std::vector<std::string> get_counter_names(const benchmark_options& options)
   {
-    test_result<NOEXCEPT_BENCHMARK_INITIAL_VECTOR_SIZE> result(
-      "std::vector<my_string> reserve");
+    std::vector<std::string> result;
 
-    for (int iteration_number = 0; iteration_number < number_of_iterations; ++iteration_number)
+    if (options.counters != nullptr)
     {
-      durations_type durations;
-      durations.duration_noexcept = noexcept_lib::test_vector_reserve();
-      durations.duration_implicit = implicit_lib::test_vector_reserve();
-      update_test_result_and_print_durations(result, durations);
+      result = options.counters->get_names();
     }
+    if (options.memory != nullptr)
+    {
+      const std::vector<std::string> memory_names = memory_sampler::get_names();
+      result.insert(result.end(), memory_names.cbegin(), memory_names.cend());
+    }
+    return result;
   }
 
-  std::cout << std::string(80, '=') << std::endl;
+
+  // The values of the last sample, in the order of get_counter_names.
+  std::vector<std::int64_t> get_counter_values(const benchmark_options& options)
+  {
+    std::vector<std::int64_t> result;
+
+    if (options.counters != nullptr)
+    {
+      result = options.counters->get_values();
+    }
+    if (options.memory != nullptr)
+    {
+      const std::vector<std::int64_t>& memory_values = options.memory->get_values();
+      result.insert(result.end(), memory_values.cbegin(), memory_values.cend());
+    }
+    return result;
+  }
+
+
+  bool has_counters(const benchmark_options& options)
+  {
+    return (options.counters != nullptr) || (options.memory != nullptr);
+  }
+
+
+  // Combines multiple sample hooks: their start functions are called in order,
+  // and their stop functions in reverse order.
+  class sample_hooks_chain
+  {
+    std::vector<sample_hooks> m_hooks;
+
+    static void start(void* const context)
+    {
+      for (const sample_hooks& hooks : static_cast<sample_hooks_chain*>(context)->m_hooks)
+      {
+        hooks.start(hooks.context);
+      }
+    }
+
+    static void stop(void* const context)
+    {
+      const std::vector<sample_hooks>& chain = static_cast<sample_hooks_chain*>(context)->m_hooks;
+
+      for (auto it = chain.crbegin(); it != chain.crend(); ++it)
+      {
+        it->stop(it->context);
+      }
+    }
+
+  public:
+    void push_back(const sample_hooks& hooks)
+    {
+      m_hooks.push_back(hooks);
+    }
+
+    bool empty() const
+    {
+      return m_hooks.empty();
+    }
+
+    sample_hooks get_sample_hooks()
+    {
+      return { this, start, stop };
+    }
+  };
+
+
+  std::string to_comma_separated_string(const std::vector<unsigned>& values)
+  {
+    std::string result;
+
+    for (const unsigned value : values)
+    {
+      result += (result.empty() ? "" : ",") + std::to_string(value);
+    }
+    return result;
+  }
+
+
+  name_value_pairs get_settings(const benchmark_options& options)
+  {
+    return
+    {
+      { "filter", options.filter },
+      { "iterations", std::to_string(options.number_of_iterations) },
+      { "calibrate", options.calibrate ? "1" : "0" },
+      { "n", to_comma_separated_string(options.N_values) },
+      { "target_sample_duration", to_short_string(options.target_sample_duration) },
+      { "confidence_interval_width", to_short_string(options.confidence_interval_width) },
+      { "time_budget", to_short_string(options.time_budget) },
+      { "counters", options.counter_names },
+      { "memory", options.measure_memory ? "1" : "0" },
+      { "order", options.order },
+      { "seed", std::to_string(options.seed) },
+      { "warmup", std::to_string(options.number_of_warmups) },
+      { "pin_cpu", std::to_string(options.cpu_index) },
+      { "threads", std::to_string(options.number_of_threads) },
+      { "throw_path_depth", std::to_string(options.throw_path_depth) },
+      { "throw_path_locals_per_frame", std::to_string(options.throw_path_locals_per_frame) },
+      { "throw_path_exception_size", std::to_string(options.throw_path_exception_size) },
+      { "huge_pages", options.huge_pages },
+      { "numa", options.numa },
+      { "prefault", options.prefault ? "1" : "0" },
+      { "isolate", options.isolate ? "1" : "0" },
+      { "high_priority", options.high_priority ? "1" : "0" }
+    };
+  }
+
+
+  // Estimates the relative width of the confidence interval on the ratio
+  // implicit/noexcept, after the specified samples.
+  double get_relative_confidence_interval_width(
+    const std::vector<double>& durations_noexcept,
+    const std::vector<double>& durations_implicit)
+  {
+    const double ratio = divide_by_positive(get_median(durations_implicit), get_median(durations_noexcept));
+    const confidence_interval interval =
+      get_bootstrap_median_ratio_interval(durations_implicit, durations_noexcept);
+    return divide_by_positive(interval.upper - interval.lower, ratio);
+  }
+
+
+  // Chooses N from [min_N, max_N] so that a single sample of each variant takes
+  // at least the target duration, unless max_N is reached first.
+  unsigned calibrate_N(const test_case& test, const double target_sample_duration)
+  {
+    unsigned N = test.min_N;
+
+    for (;;)
+    {
+      const double duration = std::min(test.func_noexcept(N), test.func_implicit(N));
+
+      if ((duration >= target_sample_duration) || (N >= test.max_N))
+      {
+        return N;
+      }
+      // Extrapolate linearly, with some margin, but at most a hundredfold at once.
+      const double factor = (duration > 0.0) ?
+        std::min(std::max(1.25 * target_sample_duration / duration, 2.0), 100.0) : 100.0;
+      N = static_cast<unsigned>(std::min(N * factor, static_cast<double>(test.max_N)));
+    }
+  }
+
+
+  // The test cases that support --threads, as they are thread-safe and do not use much memory.
+  bool is_concurrent_test_case(const test_case& test)
+  {
+    // Without the "/name" suffix of a lib variant.
+    const std::string id = test.id.substr(0, test.id.find('/'));
+    return (id == "stack_unwinding") || (id == "catching_func") || (id == "exported_func");
+  }
+
+
+  bool is_run_concurrently(const test_case& test, const benchmark_options& options)
+  {
+    return (options.number_of_threads > 1) && is_concurrent_test_case(test);
+  }
+
+
+  // The test cases whose N is limited by the size of the stack.
+  bool is_stack_bound_test_case(const test_case& test)
+  {
+    const std::string id = test.id.substr(0, test.id.find('/'));
+    return (id == "stack_unwinding") || (id == "stack_unwinding_array") || (id == "std_array");
+  }
+
+
+  // Returns the test case, with its max_N reduced to its default_N when it is
+  // stack-bound, and does not run on a thread with a larger stack (--stack-size).
+  test_case limit_N_to_stack_size(const test_case& test, const benchmark_options& options)
+  {
+    test_case result = test;
+
+    if (is_stack_bound_test_case(test) && ((options.stack_size == 0) || is_run_concurrently(test, options)))
+    {
+      result.max_N = std::min(test.max_N, test.default_N);
+    }
+    return result;
+  }
+
+
+  struct sample_pair
+  {
+    durations_type durations;
+    std::vector<std::int64_t> counter_values_noexcept;
+    std::vector<std::int64_t> counter_values_implicit;
+
+    // Only when run concurrently, while the durations are then wall clock durations.
+    std::vector<double> thread_durations_noexcept;
+    std::vector<double> thread_durations_implicit;
+  };
+
+
+  // Takes a sample of both variants, one directly after the other, in the
+  // specified order. Pins the thread first, when a CPU is specified.
+  sample_pair take_sample_pair(
+    const test_case& test,
+    const unsigned N,
+    const bool is_noexcept_first,
+    const benchmark_options& options)
+  {
+    sample_pair result{};
+
+    const auto take_sample = [&test, N, &options, &result](const bool is_noexcept, double& duration,
+      std::vector<std::int64_t>& counter_values)
+    {
+      const auto func = is_noexcept ? test.func_noexcept : test.func_implicit;
+
+      if (is_run_concurrently(test, options))
+      {
+        // The threads are pinned from CPU 0 on, when --pin-cpu is not specified.
+        const concurrent_sample sample = run_concurrently(func, N, options.number_of_threads,
+          static_cast<unsigned>(std::max(options.cpu_index, 0)));
+        duration = sample.wall_clock_duration;
+
+        // The call of each thread is in between its start and end time, but
+        // its duration may be measured by another timer (NOEXCEPT_BENCHMARK_TIMER).
+        if (*std::max_element(sample.thread_durations.cbegin(), sample.thread_durations.cend()) >
+          1.01 * sample.wall_clock_duration)
+        {
+          std::cerr << "Warning: The duration of a thread exceeds the wall clock duration of all threads ("
+            << sample.wall_clock_duration << " seconds)\n";
+        }
+        (is_noexcept ? result.thread_durations_noexcept : result.thread_durations_implicit) = sample.thread_durations;
+        return;
+      }
+      duration = func(N);
+
+      if (has_counters(options))
+      {
+        counter_values = get_counter_values(options);
+      }
+    };
+
+    if (options.cpu_index >= 0)
+    {
+      pin_current_thread(static_cast<unsigned>(options.cpu_index));
+    }
+    if (is_noexcept_first)
+    {
+      take_sample(true, result.durations.duration_noexcept, result.counter_values_noexcept);
+      take_sample(false, result.durations.duration_implicit, result.counter_values_implicit);
+    }
+    else
+    {
+      take_sample(false, result.durations.duration_implicit, result.counter_values_implicit);
+      take_sample(true, result.durations.duration_noexcept, result.counter_values_noexcept);
+    }
+    return result;
+  }
+
+
+  // Prints the throughput (N per second) of each thread and of all threads
+  // together, based on the medians of the durations.
+  void print_throughput(
+    std::ostream& output,
+    const unsigned N,
+    const std::vector<double>& wall_clock_durations_noexcept,
+    const std::vector<double>& wall_clock_durations_implicit,
+    const std::vector<std::vector<double>>& thread_durations_noexcept,
+    const std::vector<std::vector<double>>& thread_durations_implicit)
+  {
+    const auto width = static_cast<int>(output_precision + 4);
+    const auto number_of_threads = thread_durations_noexcept.size();
+    const auto print_row = [&output, width](const double noexcept_throughput, const double implicit_throughput,
+      const std::string& label)
+    {
+      output
+        << '\n'
+        << indent
+        << std::setw(width)
+        << noexcept_throughput
+        << column_gap
+        << get_comparison_char(noexcept_throughput, implicit_throughput)
+        << column_gap
+        << std::setw(width)
+        << implicit_throughput
+        << column_gap
+        << "(" << label << ")";
+    };
+
+    output
+      << std::setprecision(0)
+      << indent
+      << "(throughput in N per second, on " << number_of_threads << " threads)";
+
+    for (std::size_t thread_index = 0; thread_index < number_of_threads; ++thread_index)
+    {
+      print_row(
+        divide_by_positive(N, get_median(thread_durations_noexcept[thread_index])),
+        divide_by_positive(N, get_median(thread_durations_implicit[thread_index])),
+        "thread " + std::to_string(thread_index));
+    }
+    print_row(
+      divide_by_positive(static_cast<double>(N) * number_of_threads, get_median(wall_clock_durations_noexcept)),
+      divide_by_positive(static_cast<double>(N) * number_of_threads, get_median(wall_clock_durations_implicit)),
+      "aggregate");
+    output << std::setprecision(output_precision) << std::endl;
+  }
+
+
+  // Takes the samples of the test case, after the warm-up pairs. Stores the
+  // durations of each thread as well, when the test case is run concurrently.
+  void take_samples(
+    test_result& result,
+    const test_case& test,
+    const unsigned N,
+    const benchmark_options& options,
+    std::vector<std::vector<double>>& thread_durations_noexcept,
+    std::vector<std::vector<double>>& thread_durations_implicit)
+  {
+    using namespace std::chrono;
+
+    const auto start_time = steady_clock::now();
+    const std::vector<double>& durations_noexcept = result.get_record().noexcept_variant.durations;
+    const std::vector<double>& durations_implicit = result.get_record().implicit_variant.durations;
+
+    std::mt19937 random_engine(options.seed);
+
+    // Returns whether the noexcept variant goes first, in the pair of samples with the specified index.
+    const auto is_noexcept_first = [&options, &random_engine](const std::size_t pair_index)
+    {
+      return (options.order == "abba") ? (pair_index % 2 == 0) :
+        (options.order == "random") ? std::bernoulli_distribution()(random_engine) : true;
+    };
+
+    for (int i = 0; i < options.number_of_warmups; ++i)
+    {
+      take_sample_pair(test, N, is_noexcept_first(static_cast<std::size_t>(i)), options);
+    }
+
+    // Keeps sampling after number_of_iterations, when a confidence interval
+    // width is requested, until either it is reached or the time budget runs out.
+    while (static_cast<int>(durations_noexcept.size()) < options.number_of_iterations ||
+      ((options.confidence_interval_width > 0.0) &&
+        (duration_cast<duration<double>>(steady_clock::now() - start_time).count() < options.time_budget) &&
+        (get_relative_confidence_interval_width(durations_noexcept, durations_implicit) >
+          options.confidence_interval_width)))
+    {
+      const sample_pair pair = take_sample_pair(test, N, is_noexcept_first(durations_noexcept.size()), options);
+
+      if (has_counters(options))
+      {
+        result.update_counter_values(pair.counter_values_noexcept, pair.counter_values_implicit);
+      }
+      for (std::size_t thread_index = 0; thread_index < thread_durations_noexcept.size(); ++thread_index)
+      {
+        thread_durations_noexcept[thread_index].push_back(pair.thread_durations_noexcept.at(thread_index));
+        thread_durations_implicit[thread_index].push_back(pair.thread_durations_implicit.at(thread_index));
+      }
+      result.update_test_result_and_print_durations(pair.durations);
+    }
+  }
+
+
+  test_case_record run_test_case(
+    std::ostream& output,
+    const test_case& test,
+    const unsigned N,
+    const benchmark_options& options)
+  {
+    const bool is_concurrent = is_run_concurrently(test, options);
+    std::vector<std::vector<double>> thread_durations_noexcept(is_concurrent ? options.number_of_threads : 0);
+    std::vector<std::vector<double>> thread_durations_implicit(thread_durations_noexcept.size());
+
+    // The durations of concurrent runs are wall clock durations, from the start
+    // of the first thread until the end of the last one.
+    const std::string description = is_concurrent ?
+      (test.description + std::string(", on ") + std::to_string(options.number_of_threads) + " threads") :
+      test.description;
+
+    test_case_record record;
+    {
+      test_result result(output, test.id, description, N, test.bytes_per_N, test.is_N_calls,
+        get_counter_names(options));
+      const void* const address_noexcept = reinterpret_cast<const void*>(test.func_noexcept);
+      const void* const address_implicit = reinterpret_cast<const void*>(test.func_implicit);
+      const shared_lib_code_size& code_size_noexcept = get_shared_lib_code_size(address_noexcept);
+      const shared_lib_code_size& code_size_implicit = get_shared_lib_code_size(address_implicit);
+      result.set_code_sizes(
+        code_size_noexcept.get_function_size(address_noexcept),
+        code_size_implicit.get_function_size(address_implicit));
+
+      // Without the lib variant suffix, like "/O2".
+      const std::string id = test.id.substr(0, test.id.find('/'));
+      result.set_loop_vectorizations(
+        get_loop_vectorization(code_size_noexcept.get_file_name(), id),
+        get_loop_vectorization(code_size_implicit.get_file_name(), id));
+      take_samples(result, test, N, options, thread_durations_noexcept, thread_durations_implicit);
+      record = result.get_record();
+    }
+
+    if (is_concurrent)
+    {
+      print_throughput(output, N, record.noexcept_variant.durations, record.implicit_variant.durations,
+        thread_durations_noexcept, thread_durations_implicit);
+    }
+    return record;
+  }
+
+
+  // The file of the executable itself.
+  std::string get_executable_file_name()
+  {
+#ifdef __linux__
+    return "/proc/self/exe";
+#else
+    return get_shared_lib_code_size(reinterpret_cast<const void*>(test_noexcept_exported_func)).get_file_name();
+#endif
+  }
+
+
+  // The key of a test case record in the result cache, or an empty key, when
+  // a lib file of the test case, or the executable, cannot be read. The hash of
+  // the executable is included, as the driver (for example, its timer and its
+  // statistics) affects the results as well. Does not include the settings that
+  // only select the test cases, or their N. When N is calibrated, the key has
+  // "calibrated" as its N, as the calibrated N depends on the timing, while the
+  // settings have the target sample duration.
+  name_value_pairs get_result_cache_key(const test_case& test, const unsigned N, const benchmark_options& options)
+  {
+    const std::string& hash_noexcept = get_file_hash(
+      get_shared_lib_code_size(reinterpret_cast<const void*>(test.func_noexcept)).get_file_name());
+    const std::string& hash_implicit = get_file_hash(
+      get_shared_lib_code_size(reinterpret_cast<const void*>(test.func_implicit)).get_file_name());
+    const std::string& hash_executable = get_file_hash(get_executable_file_name());
+
+    if (hash_noexcept.empty() || hash_implicit.empty() || hash_executable.empty())
+    {
+      return {};
+    }
+    name_value_pairs key
+    {
+      { "test_case", test.id },
+      { "N", (N == N_to_be_calibrated) ? std::string("calibrated") : std::to_string(N) },
+      { "noexcept_lib_hash", hash_noexcept },
+      { "implicit_lib_hash", hash_implicit },
+      { "executable_hash", hash_executable }
+    };
+
+    for (const auto& pair : get_environment())
+    {
+      if (pair.first != "date_time")
+      {
+        key.push_back(pair);
+      }
+    }
+    for (const auto& pair : get_settings(options))
+    {
+      if ((pair.first != "filter") && (pair.first != "n"))
+      {
+        key.push_back(pair);
+      }
+    }
+    return key;
+  }
+
+
+  // Prints a record from the result cache, like run_test_case.
+  void print_cached_test_case(std::ostream& output, const test_case& test, const test_case_record& record,
+    const std::string& file_name)
+  {
+    test_result result(output, record.id, record.description, record.N, record.bytes_per_N, test.is_N_calls,
+      record.counter_names);
+    output << '\n' << indent << "(from the result cache, " << file_name << ")";
+    result.set_code_sizes(record.noexcept_variant.code_size, record.implicit_variant.code_size);
+    result.set_loop_vectorizations(record.noexcept_variant.vectorization, record.implicit_variant.vectorization);
+
+    for (std::size_t i = 0; i < record.noexcept_variant.durations.size(); ++i)
+    {
+      result.update_test_result_and_print_durations(
+        { record.noexcept_variant.durations[i], record.implicit_variant.durations[i] });
+    }
+    for (std::size_t i = 0; !record.counter_names.empty() && (i < record.noexcept_variant.counter_values.size()); ++i)
+    {
+      result.update_counter_values(record.noexcept_variant.counter_values[i], record.implicit_variant.counter_values[i]);
+    }
+  }
+
+
+  // With --cache-dir, returns the record from the result cache, if any (unless
+  // --force is specified). Otherwise runs the test case, and stores its record
+  // in the cache. The concurrent runs are not cached, as their record does not
+  // have the durations per thread. When N is N_to_be_calibrated, it is only
+  // calibrated when the test case is actually run, so that a cached test case
+  // is skipped entirely.
+  test_case_record run_test_case_or_read_cache(
+    std::ostream& output,
+    const test_case& test,
+    const unsigned N,
+    const benchmark_options& options)
+  {
+    const name_value_pairs key = (options.cache_dir.empty() || is_run_concurrently(test, options)) ?
+      name_value_pairs{} : get_result_cache_key(test, N, options);
+    const auto get_N_to_run = [&test, N, &options]
+    {
+      return (N == N_to_be_calibrated) ? calibrate_N(test, options.target_sample_duration) : N;
+    };
+
+    if (key.empty())
+    {
+      return run_test_case(output, test, get_N_to_run(), options);
+    }
+    const std::string file_name = get_result_cache_file_name(options.cache_dir, key);
+    test_case_record record;
+
+    if (!options.force && read_cached_record(file_name, key, record))
+    {
+      print_cached_test_case(output, test, record, file_name);
+      return record;
+    }
+    record = run_test_case(output, test, get_N_to_run(), options);
+
+    if (!write_cached_record(file_name, key, record))
+    {
+      std::cerr << "Warning: Failed to write the result cache file \"" << file_name << "\"\n";
+    }
+    return record;
+  }
+
+
+  // Times batches of N = batch_size calls (clamped to [min_N, max_N]) of both
+  // variants, alternately, and prints the percentiles of the latency per call,
+  // from a histogram, after subtracting the timer overhead from each batch.
+  // When N > 1, each recorded latency is the mean latency per call of a batch,
+  // so that a spike of a single call is divided by N. Only a batch size of 1
+  // measures the tail latency of individual calls.
+  void run_latency_test_case(std::ostream& output, const test_case& test, const benchmark_options& options)
+  {
+    const unsigned N = std::min(std::max(options.batch_size, test.min_N), test.max_N);
+    const double timer_overhead = measure_timer_overhead<default_timer>();
+    const auto width = static_cast<int>(output_precision + 2);
+
+    latency_histogram histogram_noexcept;
+    latency_histogram histogram_implicit;
+
+    const std::string latency_description = (N == 1) ? "latency per call" : "mean latency per call of each batch";
+
+    print_test_case_header(output, test.description + ", " + latency_description, N, "latencies in nanoseconds");
+
+    for (int i = 0; i < options.number_of_warmups; ++i)
+    {
+      test.func_noexcept(N);
+      test.func_implicit(N);
+    }
+
+    for (unsigned batch_index = 0; batch_index < options.number_of_latency_batches; ++batch_index)
+    {
+      // Alternates which variant goes first, like --order=abba.
+      double duration_noexcept;
+      double duration_implicit;
+
+      if (batch_index % 2 == 0)
+      {
+        duration_noexcept = test.func_noexcept(N);
+        duration_implicit = test.func_implicit(N);
+      }
+      else
+      {
+        duration_implicit = test.func_implicit(N);
+        duration_noexcept = test.func_noexcept(N);
+      }
+      // Clamped at zero, as the overhead (the shortest duration of an empty
+      // timer interval) may be longer than an individual duration.
+      histogram_noexcept.record(std::max(duration_noexcept - timer_overhead, 0.0) / N);
+      histogram_implicit.record(std::max(duration_implicit - timer_overhead, 0.0) / N);
+    }
+
+    const auto print_row = [&output, width](const double seconds_noexcept, const double seconds_implicit,
+      const char* const label)
+    {
+      output
+        << '\n'
+        << indent
+        << std::setw(width)
+        << (1e9 * seconds_noexcept)
+        << column_gap
+        << get_comparison_char(seconds_noexcept, seconds_implicit)
+        << column_gap
+        << std::setw(width)
+        << (1e9 * seconds_implicit)
+        << column_gap
+        << "(" << label << ")";
+    };
+
+    output
+      << std::setprecision(3);
+
+    for (const auto& percentile : { std::make_pair(0.5, "p50"), std::make_pair(0.99, "p99"),
+      std::make_pair(0.999, "p99.9") })
+    {
+      print_row(histogram_noexcept.get_percentile(percentile.first), histogram_implicit.get_percentile(percentile.first),
+        percentile.second);
+    }
+    print_row(histogram_noexcept.get_max(), histogram_implicit.get_max(), "max");
+    output
+      << std::setprecision(1)
+      << '\n' << indent << "(" << histogram_noexcept.get_total_count() << " batches of " << N
+      << ((N == 1) ? " call" : " calls") << " per variant, minus a timer overhead of "
+      << (1e9 * timer_overhead) << " ns per batch)"
+      << std::setprecision(output_precision) << std::endl;
+  }
+
+
+  // Prints the medians per N of a sweep over the N values of a test case,
+  // to see how the difference between the variants depends on N.
+  void print_sweep_summary(std::ostream& output, const std::vector<test_case_record>& records)
+  {
+    const auto width = static_cast<int>(output_precision + 2);
+
+    output
+      << '\n' << records.front().description << ", medians per N, in nanoseconds:\n"
+      << indent << std::setw(width) << "N" << column_gap
+      << std::setw(width) << "noexcept" << column_gap
+      << std::setw(width) << "implicit" << column_gap << "implicit/noexcept";
+
+    for (const test_case_record& record : records)
+    {
+      const double median_noexcept = get_median(record.noexcept_variant.durations);
+      const double median_implicit = get_median(record.implicit_variant.durations);
+
+      output
+        << '\n' << indent << std::setw(width) << record.N << column_gap
+        << std::setprecision(3)
+        << std::setw(width) << (1e9 * median_noexcept / record.N) << column_gap
+        << std::setw(width) << (1e9 * median_implicit / record.N) << column_gap
+        << std::setprecision(2)
+        << divide_by_positive(median_implicit, median_noexcept)
+        << std::setprecision(output_precision);
+    }
+    output << std::endl;
+  }
+
+
+  // Returns the N values to run the test case with: either those specified by
+  // --n (clamped to [min_N, max_N]), or a single default N, or N_to_be_calibrated
+  // (with --calibrate), as it is only calibrated when the test case is run.
+  std::vector<unsigned> get_N_values(const test_case& test, const benchmark_options& options)
+  {
+    if (options.sweep)
+    {
+      // The powers of ten between min_N and max_N, on a log scale.
+      std::vector<unsigned> result{ test.min_N };
+      unsigned long long N = 1;
+
+      while (N * 10 <= test.max_N)
+      {
+        N *= 10;
+
+        if (N > test.min_N)
+        {
+          result.push_back(static_cast<unsigned>(N));
+        }
+      }
+      return result;
+    }
+    if (options.N_values.empty())
+    {
+      return { options.calibrate ? N_to_be_calibrated : test.default_N };
+    }
+    std::vector<unsigned> result;
+
+    for (const unsigned N : options.N_values)
+    {
+      const unsigned clamped_N = std::min(std::max(N, test.min_N), test.max_N);
+
+      if (clamped_N != N)
+      {
+        std::cerr << "Note: " << test.id << " uses N = " << clamped_N << " instead of " << N
+          << ", as its N must be between " << test.min_N << " and " << test.max_N << '\n';
+      }
+      result.push_back(clamped_N);
+    }
+    return result;
+  }
+
+
+  // Parses a comma separated list of positive integers, like "1000,1000000".
+  // Returns an empty list when the text is not valid.
+  std::vector<unsigned> parse_N_values(const std::string& text)
+  {
+    std::istringstream stream{ text };
+    std::string item;
+    std::vector<unsigned> result;
+
+    while (std::getline(stream, item, ','))
+    {
+      char* end = nullptr;
+      const unsigned long value = std::strtoul(item.c_str(), &end, 10);
+
+      if (item.empty() || (*end != '\0') || (value == 0) || (value > UINT_MAX))
+      {
+        return {};
+      }
+      result.push_back(static_cast<unsigned>(value));
+    }
+    return result;
+  }
+
+
+  // Parses a non-negative integer, like "10". Returns a negative value when
+  // the text is not a valid integer (including trailing characters, as in
+  // "10x"), or when it does not fit in an int.
+  int parse_integer(const std::string& text)
+  {
+    if (text.empty() || (text[0] < '0') || (text[0] > '9'))
+    {
+      return -1;
+    }
+    char* end = nullptr;
+    errno = 0;
+    const long value = std::strtol(text.c_str(), &end, 10);
+    return ((*end != '\0') || (errno == ERANGE) || (value > INT_MAX)) ? -1 : static_cast<int>(value);
+  }
+
+
+  // Rounds a parsed integer up to the smallest supported value that is not
+  // less than it. Returns a negative value when the integer is negative, or
+  // larger than the largest supported value.
+  int round_up_to_supported_value(const int value, const std::initializer_list<int> supported_values)
+  {
+    if (value >= 0)
+    {
+      for (const int supported_value : supported_values)
+      {
+        if (value <= supported_value)
+        {
+          return supported_value;
+        }
+      }
+    }
+    return -1;
+  }
+
+
+  // Parses a duration like "50ms", "2.5s" or "3" (seconds). Returns a negative
+  // value when the text is not a valid duration.
+  double parse_duration(const std::string& text)
+  {
+    std::istringstream stream{ text };
+    double value = -1.0;
+    std::string unit;
+
+    if (!(stream >> value) || (value < 0.0))
+    {
+      return -1.0;
+    }
+    stream >> unit;
+    return (unit.empty() || unit == "s") ? value : (unit == "ms") ? value / 1000.0 : -1.0;
+  }
+
+
+  // Parses a number of bytes, optionally followed by K, M or G (binary
+  // multiples), like "1G". Returns zero when the text is not valid.
+  std::size_t parse_byte_size(const std::string& text)
+  {
+    std::istringstream stream{ text };
+    unsigned long long value = 0;
+    std::string unit;
+
+    if (!(stream >> value))
+    {
+      return 0;
+    }
+    stream >> unit;
+    const unsigned shift = unit.empty() ? 0 : (unit == "K") ? 10 : (unit == "M") ? 20 : (unit == "G") ? 30 : 64;
+    return ((shift < 64) && (value <= (std::numeric_limits<std::size_t>::max() >> shift))) ?
+      static_cast<std::size_t>(value << shift) : 0;
+  }
+
+
+  // Parses a fraction like "0.05" or a percentage like "5%". Returns a negative
+  // value when the text is not a valid fraction.
+  double parse_fraction(const std::string& text)
+  {
+    std::istringstream stream{ text };
+    double value = -1.0;
+    std::string unit;
+
+    if (!(stream >> value) || (value < 0.0))
+    {
+      return -1.0;
+    }
+    stream >> unit;
+    return unit.empty() ? value : (unit == "%") ? value / 100.0 : -1.0;
+  }
+
+
+  // Returns true, and stores the text after the '=', when the argument has
+  // the specified option name, as in "--name=value".
+  bool get_option_value(const std::string& arg, const std::string& name, std::string& value)
+  {
+    const std::string prefix = name + '=';
+
+    if (arg.compare(0, prefix.size(), prefix) == 0)
+    {
+      value = arg.substr(prefix.size());
+      return true;
+    }
+    return false;
+  }
+
+
+  // Prints the copy and move operations of the move audit of both libs of the
+  // variant, per standard operation, and whether the implicit lib copies more.
+  void print_move_audit(std::ostream& output, const lib_variant& variant, const unsigned N)
+  {
+    const move_audit_entry* entry_noexcept = variant.noexcept_lib.get_move_audit(N);
+    const move_audit_entry* entry_implicit = variant.implicit_lib.get_move_audit(N);
+    const int operation_width = 36;
+    const int count_width = 9;
+
+    output
+      << "\n[Move audit of " << (variant.name.empty() ? "the libs" : ("lib variant " + variant.name))
+      << ", on counting_wrapper<my_string> (N = " << N << ")]\n"
+      << indent << std::setw(operation_width) << "" << "noexcept" << std::string(4 * count_width - 8, ' ')
+      << column_gap << "implicit\n"
+      << indent << std::left << std::setw(operation_width) << "(copy and move operations)" << std::right;
+
+    for (int i = 0; i < 2; ++i)
+    {
+      output << ((i == 0) ? "" : column_gap.c_str())
+        << std::setw(count_width) << "copy-c" << std::setw(count_width) << "move-c"
+        << std::setw(count_width) << "copy-a" << std::setw(count_width) << "move-a";
+    }
+
+    for (; (entry_noexcept->operation != nullptr) && (entry_implicit->operation != nullptr);
+      ++entry_noexcept, ++entry_implicit)
+    {
+      output << '\n' << indent << std::left << std::setw(operation_width) << entry_noexcept->operation << std::right;
+
+      for (const move_audit_entry* const entry : { entry_noexcept, entry_implicit })
+      {
+        const copy_move_counts& counts = entry->counts;
+        output << ((entry == entry_noexcept) ? "" : column_gap.c_str())
+          << std::setw(count_width) << counts.copy_constructions
+          << std::setw(count_width) << counts.move_constructions
+          << std::setw(count_width) << counts.copy_assignments
+          << std::setw(count_width) << counts.move_assignments;
+      }
+      if (entry_implicit->counts.copy_constructions + entry_implicit->counts.copy_assignments >
+        entry_noexcept->counts.copy_constructions + entry_noexcept->counts.copy_assignments)
+      {
+        output << column_gap << "<- copies instead of moves";
+      }
+    }
+    output << std::endl;
+  }
+
+
+  // Precedes the JSON results that an isolated child process writes to its standard output.
+  const char* const isolated_results_marker = "[noexcept_benchmark isolated results]";
+
+
+  // Returns the command to run the specified test case in a child process, by
+  // the same program, with the same options, except for those that only
+  // concern the output of the parent process.
+  std::string get_isolated_test_command(const std::vector<std::string>& args, const std::string& test_id)
+  {
+    std::string command = quote_command_argument(args.at(0));
+
+    for (std::size_t i = 1; i < args.size(); ++i)
+    {
+      const std::string& arg = args[i];
+      std::string value;
+
+      if ((arg != "--isolate") &&
+        !get_option_value(arg, "--filter", value) &&
+        !get_option_value(arg, "--format", value) &&
+        !get_option_value(arg, "--out", value) &&
+        !get_option_value(arg, "--compare", value) &&
+        !get_option_value(arg, "--threshold", value))
+      {
+        command += ' ' + quote_command_argument(arg);
+      }
+    }
+    return command + ' ' + quote_command_argument("--isolated-test=" + test_id);
+  }
+
+
+  // Runs the command of an isolated test case, passes its text output through,
+  // and adds its results to the records. Keeps both variants of the test case
+  // in the same child process, so that its samples are still taken in pairs.
+  bool run_isolated_test_case(std::ostream& output, const std::string& command, std::vector<test_case_record>& records)
+  {
+    bool is_marker_found = false;
+    std::string json_text;
+
+    const int exit_code = run_command(command, [&output, &is_marker_found, &json_text](const std::string& line)
+      {
+        if (is_marker_found)
+        {
+          json_text += line + '\n';
+        }
+        else if (line == isolated_results_marker)
+        {
+          is_marker_found = true;
+        }
+        else
+        {
+          output << line << std::endl;
+        }
+      });
+
+    if ((exit_code != EXIT_SUCCESS) || !is_marker_found)
+    {
+      return false;
+    }
+    std::istringstream json_stream(json_text);
+    std::string error_message;
+
+    if (!read_json_records(json_stream, records, error_message))
+    {
+      std::cerr << "Error: Failed to read the results of an isolated test case: " << error_message << '\n';
+      return false;
+    }
+    return true;
+  }
+
+
+  void print_usage(const char* const program_name)
+  {
+    std::cout
+      << "Usage: " << program_name << " [options]\n"
+      << indent << "--filter=PATTERNS      Only run the test cases whose id or description matches\n"
+      << indent << "                       one of the comma separated wildcard PATTERNS (e.g. vector*)\n"
+      << indent << "--list                 List the ids of the test cases, and exit\n"
+      << indent << "--plugin=NAME=NOEXCEPT_LIB,IMPLICIT_LIB\n"
+      << indent << "                       Load a noexcept lib and an implicit lib at run-time (possibly\n"
+      << indent << "                       built by another compiler), and run their tests as variant NAME\n"
+      << indent << "--iterations=K         Take (at least) K samples per test case (default "
+      << NOEXCEPT_BENCHMARK_NUMBER_OF_ITERATIONS << ")\n"
+      << indent << "--n=LIST               Run each test case with each N of the comma separated LIST,\n"
+      << indent << "                       for example --n=1000,1000000,100000000\n"
+      << indent << "--calibrate            Choose N per test case, so that a sample takes the target time\n"
+      << indent << "--target-time=TIME     Target duration of a sample, for --calibrate (default 50ms)\n"
+      << indent << "--ci-width=FRACTION    Keep sampling until the 95% confidence interval on the ratio\n"
+      << indent << "                       implicit/noexcept is narrower than FRACTION (e.g. 0.02 or 2%)\n"
+      << indent << "--time-budget=TIME     Maximum time per test case, for --ci-width (default 60s)\n"
+      << indent << "--order=ORDER          Order of the variants within each pair of samples: fixed\n"
+      << indent << "                       (noexcept first, default), abba (alternating) or random\n"
+      << indent << "--seed=S               Seed of the random order, for --order=random (default 0)\n"
+      << indent << "--warmup=K             Take and discard K pairs of samples before the measured ones\n"
+      << indent << "--pin-cpu=C            Pin the thread to CPU C (zero-based), before each pair of samples\n"
+      << indent << "--high-priority        Raise the priority of the process (which may need elevated privileges)\n"
+      << indent << "--isolate              Run each test case in a fresh child process, with the same options\n"
+      << indent << "--threads=K            Run the stack_unwinding, catching_func and exported_func test\n"
+      << indent << "                       cases on K threads concurrently, and report their throughput.\n"
+      << indent << "                       The threads are pinned to consecutive CPUs, from C (or 0) on\n"
+      << indent << "--throw-depth=D        Number of frames per throw, for the throw_path tests (default "
+      << NOEXCEPT_BENCHMARK_THROW_PATH_DEPTH << ")\n"
+      << indent << "--throw-locals=L       Destructible locals per frame, for the throw_path tests: 0, 1, 4\n"
+      << indent << "                       or 16, otherwise rounded up, at most 16 (default "
+      << NOEXCEPT_BENCHMARK_THROW_PATH_LOCALS_PER_FRAME << ")\n"
+      << indent << "--throw-size=BYTES     Exception object size, for the throw_path tests: 16, 256 or\n"
+      << indent << "                       4096, otherwise rounded up, at most 4096 (default "
+      << NOEXCEPT_BENCHMARK_THROW_PATH_EXCEPTION_SIZE << ")\n"
+      << indent << "--huge-pages=MODE      Back the vector and the strings of vector_reserve by huge pages:\n"
+      << indent << "                       none (default), transparent or explicit (Linux only)\n"
+      << indent << "--numa=PLACEMENT       NUMA placement of the memory of vector_reserve: default (first\n"
+      << indent << "                       touch), local or interleave (Linux only)\n"
+      << indent << "--prefault             Touch each page of the memory of vector_reserve when allocating it\n"
+      << indent << "--latency=K            Instead of durations, time K batches of calls per variant, and\n"
+      << indent << "                       print the p50, p99, p99.9 and max latency per call (text only)\n"
+      << indent << "--batch-size=B         Number of calls (N) per batch, for --latency (default 100). Each\n"
+      << indent << "                       latency is then the mean per call of a batch. Use 1 for the tail\n"
+      << indent << "                       latency of individual calls\n"
+      << indent << "--sweep                Run each test case with each power of ten N in [min N, max N], and\n"
+      << indent << "                       print the medians per N, on a log scale\n"
+      << indent << "--stack-size=BYTES     Run the test cases on a thread with a stack of BYTES (e.g. 1G), which\n"
+      << indent << "                       allows a larger N for the stack_unwinding test cases\n"
+      << indent << "--counters=NAMES       Read the comma separated hardware counters around each sample.\n"
+      << indent << "                       Supported: " << hardware_counters::get_supported_names() << "\n"
+      << indent << "--memory               Count the allocations and allocated bytes, and measure the peak\n"
+      << indent << "                       resident set size, of each sample\n"
+      << indent << "--audit                Print the copy and move operations of standard operations (like\n"
+      << indent << "                       std::sort) on N = 1000 elements (or the first of --n), and exit\n"
+      << indent << "--cache-dir=DIR        Read the results of unchanged test cases from the result cache in\n"
+      << indent << "                       the (existing) directory DIR, and write the other ones to it\n"
+      << indent << "--force                Run all test cases, even those in the result cache of --cache-dir\n"
+      << indent << "--format=FORMAT        Output format of the results: text (default), json or csv\n"
+      << indent << "--out=FILE             Write the results of --format=json or csv to FILE, instead of to\n"
+      << indent << "                       the standard output\n"
+      << indent << "--compare=FILE         Compare the results to those of a baseline run, written by\n"
+      << indent << "                       --format=json, and exit with a failure on a significant regression\n"
+      << indent << "--threshold=FRACTION   Relative change regarded as a regression, for --compare (default 5%)\n"
+      << indent << "--help                 Print this help message, and exit\n";
+  }
+
+}
+
+int main(int argc, char** argv)
+{
+  const std::vector<std::string> args(argv, argv + argc);
+  benchmark_options options;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    const std::string arg = argv[i];
+    std::string value;
+    bool is_valid_option = true;
+
+    if (get_option_value(arg, "--filter", value))
+    {
+      options.filter = value;
+    }
+    else if (get_option_value(arg, "--plugin", value))
+    {
+      std::string error_message;
+
+      if (!add_plugin_lib_variant(value, error_message))
+      {
+        std::cerr << "Error: Invalid option \"" << arg << "\": " << error_message << '\n';
+        return EXIT_FAILURE;
+      }
+    }
+    else if (arg == "--list")
+    {
+      for (const test_case& test : get_registered_test_cases())
+      {
+        std::cout << test.id << column_gap << "(" << test.description << ", N = " << test.default_N << ")\n";
+      }
+      return EXIT_SUCCESS;
+    }
+    else if (get_option_value(arg, "--iterations", value))
+    {
+      options.number_of_iterations = parse_integer(value);
+      is_valid_option = options.number_of_iterations > 0;
+    }
+    else if (get_option_value(arg, "--n", value))
+    {
+      options.N_values = parse_N_values(value);
+      is_valid_option = !options.N_values.empty();
+    }
+    else if (arg == "--calibrate")
+    {
+      options.calibrate = true;
+    }
+    else if (get_option_value(arg, "--target-time", value))
+    {
+      options.target_sample_duration = parse_duration(value);
+      is_valid_option = options.target_sample_duration > 0.0;
+    }
+    else if (get_option_value(arg, "--ci-width", value))
+    {
+      options.confidence_interval_width = parse_fraction(value);
+      is_valid_option = (options.confidence_interval_width > 0.0) && (options.confidence_interval_width < 1.0);
+    }
+    else if (get_option_value(arg, "--time-budget", value))
+    {
+      options.time_budget = parse_duration(value);
+      is_valid_option = options.time_budget > 0.0;
+    }
+    else if (get_option_value(arg, "--order", value))
+    {
+      options.order = value;
+      is_valid_option = (value == "fixed") || (value == "abba") || (value == "random");
+    }
+    else if (get_option_value(arg, "--seed", value))
+    {
+      char* end = nullptr;
+      errno = 0;
+      const unsigned long seed = std::strtoul(value.c_str(), &end, 10);
+      options.seed = static_cast<unsigned>(seed);
+      is_valid_option = !value.empty() && (value[0] >= '0') && (value[0] <= '9') && (*end == '\0') &&
+        (errno != ERANGE) && (seed <= UINT_MAX);
+    }
+    else if (get_option_value(arg, "--warmup", value))
+    {
+      options.number_of_warmups = parse_integer(value);
+      is_valid_option = options.number_of_warmups >= 0;
+    }
+    else if (arg == "--isolate")
+    {
+      options.isolate = true;
+    }
+    else if (get_option_value(arg, "--isolated-test", value))
+    {
+      options.isolated_test_id = value;
+      is_valid_option = !value.empty();
+    }
+    else if (arg == "--high-priority")
+    {
+      options.high_priority = true;
+    }
+    else if (get_option_value(arg, "--pin-cpu", value))
+    {
+      options.cpu_index = parse_integer(value);
+      is_valid_option = options.cpu_index >= 0;
+    }
+    else if (get_option_value(arg, "--threads", value))
+    {
+      const int number_of_threads = parse_integer(value);
+      options.number_of_threads = static_cast<unsigned>(number_of_threads);
+      is_valid_option = number_of_threads > 0;
+    }
+    else if (get_option_value(arg, "--throw-depth", value))
+    {
+      const int depth = parse_integer(value);
+      options.throw_path_depth = static_cast<unsigned>(depth);
+      is_valid_option = depth > 0;
+    }
+    else if (get_option_value(arg, "--throw-locals", value))
+    {
+      // Stores the value that is actually used, so that the output and the key of the result cache are truthful.
+      const int locals_per_frame = round_up_to_supported_value(parse_integer(value), { 0, 1, 4, 16 });
+      options.throw_path_locals_per_frame = static_cast<unsigned>(locals_per_frame);
+      is_valid_option = locals_per_frame >= 0;
+    }
+    else if (get_option_value(arg, "--throw-size", value))
+    {
+      const int requested_exception_size = parse_integer(value);
+      const int exception_size = (requested_exception_size > 0) ?
+        round_up_to_supported_value(requested_exception_size, { 16, 256, 4096 }) : -1;
+      options.throw_path_exception_size = static_cast<unsigned>(exception_size);
+      is_valid_option = exception_size >= 0;
+    }
+    else if (get_option_value(arg, "--huge-pages", value))
+    {
+      options.huge_pages = value;
+      is_valid_option = (value == "none") || (value == "transparent") || (value == "explicit");
+    }
+    else if (get_option_value(arg, "--numa", value))
+    {
+      options.numa = value;
+      is_valid_option = (value == "default") || (value == "local") || (value == "interleave");
+    }
+    else if (arg == "--prefault")
+    {
+      options.prefault = true;
+    }
+    else if (arg == "--audit")
+    {
+      options.audit = true;
+    }
+    else if (get_option_value(arg, "--cache-dir", value))
+    {
+      options.cache_dir = value;
+      is_valid_option = !value.empty();
+    }
+    else if (arg == "--force")
+    {
+      options.force = true;
+    }
+    else if (get_option_value(arg, "--latency", value))
+    {
+      const int number_of_batches = parse_integer(value);
+      options.number_of_latency_batches = static_cast<unsigned>(number_of_batches);
+      is_valid_option = number_of_batches > 0;
+    }
+    else if (get_option_value(arg, "--batch-size", value))
+    {
+      const int batch_size = parse_integer(value);
+      options.batch_size = static_cast<unsigned>(batch_size);
+      is_valid_option = batch_size > 0;
+    }
+    else if (get_option_value(arg, "--stack-size", value))
+    {
+      options.stack_size = parse_byte_size(value);
+      is_valid_option = options.stack_size > 0;
+    }
+    else if (arg == "--sweep")
+    {
+      options.sweep = true;
+    }
+    else if (get_option_value(arg, "--counters", value))
+    {
+      options.counter_names = value;
+      is_valid_option = !value.empty();
+    }
+    else if (arg == "--memory")
+    {
+      options.measure_memory = true;
+    }
+    else if (get_option_value(arg, "--format", value))
+    {
+      options.format = value;
+      is_valid_option = (value == "text") || (value == "json") || (value == "csv");
+    }
+    else if (get_option_value(arg, "--out", value))
+    {
+      options.output_file_name = value;
+      is_valid_option = !value.empty();
+    }
+    else if (get_option_value(arg, "--compare", value))
+    {
+      options.baseline_file_name = value;
+      is_valid_option = !value.empty();
+    }
+    else if (get_option_value(arg, "--threshold", value))
+    {
+      options.threshold = parse_fraction(value);
+      is_valid_option = options.threshold >= 0.0;
+    }
+    else if (arg == "--help")
+    {
+      print_usage(argv[0]);
+      return EXIT_SUCCESS;
+    }
+    else
+    {
+      is_valid_option = false;
+    }
+
+    if (!is_valid_option)
+    {
+      std::cerr << "Error: Invalid option \"" << arg << "\"\n";
+      print_usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (options.sweep && (!options.N_values.empty() || options.calibrate))
+  {
+    std::cerr << "Error: --sweep cannot be combined with --n or --calibrate\n";
+    return EXIT_FAILURE;
+  }
+
+  if (!options.output_file_name.empty() && (options.format == "text"))
+  {
+    std::cerr << "Error: --out requires --format=json or --format=csv\n";
+    return EXIT_FAILURE;
+  }
+
+  if ((options.stack_size > 0) && !options.counter_names.empty())
+  {
+    std::cerr << "Error: --counters is not supported in combination with --stack-size, as it only counts the main thread\n";
+    return EXIT_FAILURE;
+  }
+
+  if ((options.number_of_latency_batches > 0) && ((options.format != "text") || !options.baseline_file_name.empty()))
+  {
+    std::cerr << "Error: --latency only supports the text format, and cannot be combined with --compare\n";
+    return EXIT_FAILURE;
+  }
+
+  if ((options.cpu_index >= 0) && !pin_current_thread(static_cast<unsigned>(options.cpu_index)))
+  {
+    std::cerr << "Error: Failed to pin the thread to CPU " << options.cpu_index << '\n';
+    return EXIT_FAILURE;
+  }
+
+  if (options.high_priority && !raise_current_process_priority())
+  {
+    std::cerr << "Error: Failed to raise the priority of the process (which may need elevated privileges)\n";
+    return EXIT_FAILURE;
+  }
+
+  if (options.isolate && !options.isolated_test_id.empty())
+  {
+    std::cerr << "Error: --isolate cannot be combined with --isolated-test\n";
+    return EXIT_FAILURE;
+  }
+  const bool is_isolated_child = !options.isolated_test_id.empty();
+
+  std::vector<test_case_record> baseline_records;
+
+  if (!options.baseline_file_name.empty())
+  {
+    std::ifstream baseline_file(options.baseline_file_name);
+    std::string error_message;
+
+    if (!baseline_file)
+    {
+      std::cerr << "Error: Failed to open \"" << options.baseline_file_name << "\"\n";
+      return EXIT_FAILURE;
+    }
+    if (!read_json_records(baseline_file, baseline_records, error_message))
+    {
+      std::cerr << "Error: Failed to read \"" << options.baseline_file_name << "\": " << error_message << '\n';
+      return EXIT_FAILURE;
+    }
+  }
+
+  const memory_placement placement = to_memory_placement(options);
+
+  if (placement.is_specified())
+  {
+#ifdef __linux__
+    void* const pages = allocate_pages(1, placement);
+
+    if (pages == nullptr)
+    {
+      std::cerr << "Error: Failed to allocate memory by --huge-pages=" << options.huge_pages
+        << " and --numa=" << options.numa << " (explicit huge pages may need to be reserved first)\n";
+      return EXIT_FAILURE;
+    }
+    deallocate_pages(pages, 1);
+#else
+    std::cerr << "Error: --huge-pages, --numa and --prefault are only supported on Linux\n";
+    return EXIT_FAILURE;
+#endif
+  }
+
+  // Estimated once, for the executable and all the libs.
+  const timer_calibration calibration = default_timer::calibrate();
+  get_timer_calibration<default_timer>() = calibration;
+
+  for (const lib_variant& variant : get_lib_variants())
+  {
+    for (const lib_functions* const lib : { &variant.noexcept_lib, &variant.implicit_lib })
+    {
+      lib->set_timer_calibration(NOEXCEPT_BENCHMARK_TO_STRING(NOEXCEPT_BENCHMARK_TIMER),
+        calibration.seconds_per_tick, calibration.is_counter_available ? 1 : 0);
+      lib->set_throw_path_parameters(
+        options.throw_path_depth, options.throw_path_locals_per_frame, options.throw_path_exception_size);
+      lib->set_memory_placement(static_cast<unsigned>(placement.huge_pages),
+        static_cast<unsigned>(placement.numa), placement.prefault ? 1 : 0);
+    }
+  }
+
+  if (options.audit)
+  {
+    const unsigned N = options.N_values.empty() ? 1000 : options.N_values.front();
+
+    for (const lib_variant& variant : get_lib_variants())
+    {
+      print_move_audit(std::cout, variant, N);
+    }
+    return EXIT_SUCCESS;
+  }
+
+  if ((!options.counter_names.empty() || options.measure_memory) && (options.number_of_threads > 1))
+  {
+    std::cerr << "Error: --counters and --memory are not supported in combination with --threads\n";
+    return EXIT_FAILURE;
+  }
+
+  // The memory sampler goes first, so that the hardware counters do not count its work.
+  std::unique_ptr<memory_sampler> memory;
+  std::unique_ptr<hardware_counters> counters;
+  sample_hooks_chain hooks_chain;
+
+  if (options.measure_memory)
+  {
+    memory.reset(new memory_sampler);
+    hooks_chain.push_back(memory->get_sample_hooks());
+    options.memory = memory.get();
+  }
+
+  if (!options.counter_names.empty())
+  {
+    counters.reset(new hardware_counters(options.counter_names));
+
+    if (!counters->get_error_message().empty())
+    {
+      std::cerr << "Error: " << counters->get_error_message() << '\n';
+      return EXIT_FAILURE;
+    }
+    hooks_chain.push_back(counters->get_sample_hooks());
+    options.counters = counters.get();
+  }
+
+  sample_hooks hooks = hooks_chain.get_sample_hooks();
+
+  if (!hooks_chain.empty())
+  {
+    get_sample_hooks() = &hooks;
+
+    for (const lib_variant& variant : get_lib_variants())
+    {
+      variant.noexcept_lib.set_sample_hooks(&hooks);
+      variant.implicit_lib.set_sample_hooks(&hooks);
+    }
+  }
+
+  // When the machine-readable results go to the standard output, the text goes to std::cerr.
+  const bool is_text_format = options.format == "text";
+  std::ostream& text_output = (is_text_format || !options.output_file_name.empty()) ? std::cout : std::cerr;
+
+  text_output << std::fixed << std::setprecision(output_precision);
+
+  // An isolated child process leaves the header to its parent process.
+  if (!is_isolated_child)
+  {
+    text_output
+      << "The noexcept benchmark from https://github.com/N-Dekker/noexcept_benchmark"
+      << "\n__FILE__ = " << __FILE__
+      << "\nsizeof(void*) = " << sizeof(void*)
+      << " (" << CHAR_BIT * sizeof(void*) << "-bit)"
+      << "\n__DATE__ = " << __DATE__
+      << "\n__TIME__ = " << __TIME__
+#ifdef __VERSION__
+      << "\n__VERSION__ = "
+      __VERSION__
+#endif
+#ifdef _MSC_FULL_VER
+      << "\n_MSC_FULL_VER = "
+      << _MSC_FULL_VER
+#endif
+#ifdef _MSC_BUILD
+      << "\n_MSC_BUILD = "
+      << _MSC_BUILD
+#endif
+#ifdef _DEBUG
+      << "\n_DEBUG"
+#endif
+#ifdef NDEBUG
+      << "\nNDEBUG (\"Not Debug\")"
+#endif
+      << "\nNOEXCEPT_BENCHMARK_NUMBER_OF_ITERATIONS = "
+      << NOEXCEPT_BENCHMARK_NUMBER_OF_ITERATIONS
+      << "\nNumber of iterations = "
+      << options.number_of_iterations
+      << (options.calibrate ? "\nCalibrating N per test case" : "")
+      << "\nOrder of the variants = "
+      << options.order
+      << "\nNumber of warm-up pairs = "
+      << options.number_of_warmups
+      << "\nNumber of threads = "
+      << options.number_of_threads
+      << "\nNOEXCEPT_BENCHMARK_THROW_EXCEPTION = "
+      << NOEXCEPT_BENCHMARK_THROW_EXCEPTION
+#if NOEXCEPT_BENCHMARK_THROW_EXCEPTION
+      << " (`throw exception{}` included by #if)"
+#else
+      << " (`throw exception{}` excluded by #if)"
+#endif
+      << "\nNOEXCEPT_BENCHMARK_THROW_HINT = "
+      << NOEXCEPT_BENCHMARK_TO_STRING(NOEXCEPT_BENCHMARK_THROW_HINT)
+      << "\nNOEXCEPT_BENCHMARK_TIMER = "
+      << NOEXCEPT_BENCHMARK_TO_STRING(NOEXCEPT_BENCHMARK_TIMER)
+      << std::setprecision(1)
+      << "\nTimer overhead = "
+      << 1e9 * measure_timer_overhead<default_timer>()
+      << " ns"
+      << "\nTimer resolution = "
+      << 1e9 * measure_timer_resolution<default_timer>()
+      << " ns"
+      << "\nCPU cycle (estimated) = "
+      << 1e9 * get_seconds_per_cycle()
+      << " ns"
+      << std::setprecision(output_precision)
+      << "\nCPU model = " << get_cpu_model()
+      << "\nCPU governor = " << get_cpu_governor();
+
+    for (const lib_variant& variant : get_lib_variants())
+    {
+      print_code_sizes(text_output, variant);
+    }
+    text_output << std::endl;
+  }
+
+  std::vector<test_case_record> records;
+
+  bool is_isolated_run_failed = false;
+
+  auto run_test_cases = [&text_output, &options, &records, &args, &is_isolated_run_failed]
+  {
+    for (const test_case& registered_test : get_registered_test_cases())
+    {
+      const test_case test = limit_N_to_stack_size(registered_test, options);
+
+      if (options.isolate && is_selected(test, options))
+      {
+        if (!run_isolated_test_case(text_output, get_isolated_test_command(args, test.id), records))
+        {
+          std::cerr << "Error: Failed to run test case " << test.id << " in a child process\n";
+          is_isolated_run_failed = true;
+          return;
+        }
+      }
+      else if (is_selected(test, options) && (options.number_of_latency_batches > 0))
+      {
+        run_latency_test_case(text_output, test, options);
+      }
+      else if (is_selected(test, options))
+      {
+        const auto number_of_previous_records = records.size();
+
+        for (const unsigned N : get_N_values(test, options))
+        {
+          records.push_back(run_test_case_or_read_cache(text_output, test, N, options));
+        }
+        if (options.sweep)
+        {
+          print_sweep_summary(text_output, std::vector<test_case_record>(
+            records.cbegin() + static_cast<std::ptrdiff_t>(number_of_previous_records), records.cend()));
+        }
+      }
+    }
+  };
+
+  if (options.stack_size == 0)
+  {
+    run_test_cases();
+  }
+  else if (!run_on_thread_with_stack_size(options.stack_size, run_test_cases))
+  {
+    std::cerr << "Error: Failed to create a thread with a stack size of " << options.stack_size << " bytes\n";
+    return EXIT_FAILURE;
+  }
+
+  if (is_isolated_run_failed)
+  {
+    return EXIT_FAILURE;
+  }
+
+  if (is_isolated_child)
+  {
+    // The results for the parent process, which parses them by read_json_records.
+    std::cout << isolated_results_marker << '\n';
+    write_json(std::cout, {}, {}, records);
+    return EXIT_SUCCESS;
+  }
+
+  text_output << std::string(80, '=') << std::endl;
+
+  if (!is_text_format)
+  {
+    std::ofstream output_file;
+
+    if (!options.output_file_name.empty())
+    {
+      output_file.open(options.output_file_name);
+
+      if (!output_file)
+      {
+        std::cerr << "Error: Failed to open \"" << options.output_file_name << "\"\n";
+        return EXIT_FAILURE;
+      }
+    }
+    std::ostream& output = options.output_file_name.empty() ? std::cout : output_file;
+    name_value_pairs environment = get_environment();
+    const name_value_pairs code_size_environment = get_code_size_environment();
+    environment.insert(environment.end(), code_size_environment.cbegin(), code_size_environment.cend());
+
+    if (options.format == "json")
+    {
+      write_json(output, environment, get_settings(options), records);
+    }
+    else
+    {
+      write_csv(output, environment, records);
+    }
+  }
+
+  if (!options.baseline_file_name.empty() &&
+    print_comparison_with_baseline(text_output, baseline_records, records, options.threshold, significance_level))
+  {
+    return EXIT_FAILURE;
+  }
   return 0;
 }
@@ -0,0 +1,159 @@
+/*
+Copyright Niels Dekker, LKEB, Leiden University Medical Center
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0.txt
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Replaces the global operator new and delete, to count the allocations while
+// noexcept_benchmark::memory_sampler is in use. All forms are replaced, including
+// the array, sized and over-aligned (std::align_val_t) forms, so that they are
+// all counted, and so that the compiler does not warn about a missing sized
+// operator delete (-Wsized-deallocation). The nothrow forms of the standard
+// library forward to these.
+
+#include "noexcept_benchmark_memory.h"
+
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#  include <malloc.h>
+#endif
+
+
+namespace
+{
+  // Allocates by the specified function, calling the new handler until it
+  // succeeds, as specified for the replaceable operator new.
+  template <typename T>
+  void* allocate(const std::size_t number_of_bytes, T allocate_function)
+  {
+    noexcept_benchmark::count_allocation(number_of_bytes);
+
+    for (;;)
+    {
+      void* const result = allocate_function((number_of_bytes == 0) ? 1 : number_of_bytes);
+
+      if (result != nullptr)
+      {
+        return result;
+      }
+      const std::new_handler handler = std::get_new_handler();
+
+      if (handler == nullptr)
+      {
+        throw std::bad_alloc{};
+      }
+      handler();
+    }
+  }
+
+  void* allocate_unaligned(const std::size_t number_of_bytes)
+  {
+    return allocate(number_of_bytes, [](const std::size_t size) { return std::malloc(size); });
+  }
+}
+
+
+void* operator new(const std::size_t number_of_bytes)
+{
+  return allocate_unaligned(number_of_bytes);
+}
+
+void* operator new[](const std::size_t number_of_bytes)
+{
+  return allocate_unaligned(number_of_bytes);
+}
+
+void operator delete(void* const ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete[](void* const ptr) noexcept
+{
+  std::free(ptr);
+}
+
+#ifdef __cpp_sized_deallocation
+void operator delete(void* const ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete[](void* const ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+#endif
+
+
+#ifdef __cpp_aligned_new
+namespace
+{
+  void* allocate_aligned(const std::size_t number_of_bytes, const std::align_val_t alignment)
+  {
+    const auto alignment_value = static_cast<std::size_t>(alignment);
+
+    return allocate(number_of_bytes, [alignment_value](const std::size_t size)
+    {
+#ifdef _WIN32
+      return _aligned_malloc(size, alignment_value);
+#else
+      // std::aligned_alloc needs a size that is a multiple of the alignment.
+      return std::aligned_alloc(alignment_value, (size + alignment_value - 1) / alignment_value * alignment_value);
+#endif
+    });
+  }
+
+  void deallocate_aligned(void* const ptr) noexcept
+  {
+#ifdef _WIN32
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+  }
+}
+
+
+void* operator new(const std::size_t number_of_bytes, const std::align_val_t alignment)
+{
+  return allocate_aligned(number_of_bytes, alignment);
+}
+
+void* operator new[](const std::size_t number_of_bytes, const std::align_val_t alignment)
+{
+  return allocate_aligned(number_of_bytes, alignment);
+}
+
+void operator delete(void* const ptr, std::align_val_t) noexcept
+{
+  deallocate_aligned(ptr);
+}
+
+void operator delete[](void* const ptr, std::align_val_t) noexcept
+{
+  deallocate_aligned(ptr);
+}
+
+void operator delete(void* const ptr, std::size_t, std::align_val_t) noexcept
+{
+  deallocate_aligned(ptr);
+}
+
+void operator delete[](void* const ptr, std::size_t, std::align_val_t) noexcept
+{
+  deallocate_aligned(ptr);
+}
+#endif
@@ -0,0 +1,176 @@
+#ifndef noexcept_benchmark_memory_h
+#define noexcept_benchmark_memory_h
+
+/*
+Copyright Niels Dekker, LKEB, Leiden University Medical Center
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0.txt
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Memory accounting per sample, by means of noexcept_benchmark::sample_hooks:
+// the number of allocations and allocated bytes, as counted by the replaced
+// global operator new (from noexcept_benchmark_memory.cpp), and the peak
+// resident set size.
+//
+// Note: On Windows, the operator new of the executable does not replace the
+// one of the DLLs, so that their allocations are not counted. Moreover, the
+// peak working set size of Windows (and the maximum resident set size of
+// macOS) cannot be reset, so it is the peak of the process so far.
+
+#include "noexcept_benchmark.h"
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#  include <psapi.h>
+#elif defined(__APPLE__)
+#  include <sys/resource.h>
+#endif
+
+
+namespace noexcept_benchmark
+{
+  struct allocation_statistics
+  {
+    std::atomic<bool> is_counting;
+    std::atomic<std::uint64_t> number_of_allocations;
+    std::atomic<std::uint64_t> number_of_allocated_bytes;
+  };
+
+
+  // Zero-initialized, as it has static storage duration, so that it may
+  // already be used by operator new during static initialization.
+  inline allocation_statistics& get_allocation_statistics()
+  {
+    static allocation_statistics statistics;
+    return statistics;
+  }
+
+
+  // Called by the replaced global operator new.
+  inline void count_allocation(const std::size_t number_of_bytes)
+  {
+    allocation_statistics& statistics = get_allocation_statistics();
+
+    if (statistics.is_counting.load(std::memory_order_relaxed))
+    {
+      statistics.number_of_allocations.fetch_add(1, std::memory_order_relaxed);
+      statistics.number_of_allocated_bytes.fetch_add(number_of_bytes, std::memory_order_relaxed);
+    }
+  }
+
+
+  class memory_sampler
+  {
+  public:
+    memory_sampler()
+    {
+      get_allocation_statistics().is_counting = true;
+    }
+
+    memory_sampler(const memory_sampler&) = delete;
+    memory_sampler& operator=(const memory_sampler&) = delete;
+
+    ~memory_sampler()
+    {
+      get_allocation_statistics().is_counting = false;
+    }
+
+    static std::vector<std::string> get_names()
+    {
+      return { "allocations", "allocated-bytes", "peak-rss-bytes" };
+    }
+
+    // The values of the last sample.
+    const std::vector<std::int64_t>& get_values() const
+    {
+      return m_values;
+    }
+
+    sample_hooks get_sample_hooks()
+    {
+      return { this, start, stop };
+    }
+
+  private:
+    std::vector<std::int64_t> m_values = std::vector<std::int64_t>(3);
+    std::uint64_t m_number_of_allocations = 0;
+    std::uint64_t m_number_of_allocated_bytes = 0;
+
+    static void reset_peak_resident_set_size()
+    {
+#ifdef __linux__
+      // Resets VmHWM, since Linux 4.0.
+      std::ofstream("/proc/self/clear_refs") << "5";
+#endif
+    }
+
+    static std::int64_t get_peak_resident_set_size()
+    {
+#ifdef __linux__
+      std::ifstream status("/proc/self/status");
+      std::string line;
+
+      while (std::getline(status, line))
+      {
+        if (line.compare(0, 6, "VmHWM:") == 0)
+        {
+          return 1024 * std::stoll(line.substr(6));
+        }
+      }
+      return 0;
+#elif defined(_WIN32)
+      PROCESS_MEMORY_COUNTERS memory_counters{};
+      return GetProcessMemoryInfo(GetCurrentProcess(), &memory_counters, sizeof(memory_counters)) ?
+        static_cast<std::int64_t>(memory_counters.PeakWorkingSetSize) : 0;
+#elif defined(__APPLE__)
+      rusage usage{};
+      return (getrusage(RUSAGE_SELF, &usage) == 0) ? static_cast<std::int64_t>(usage.ru_maxrss) : 0;
+#else
+      return 0;
+#endif
+    }
+
+    static void start(void* const context)
+    {
+      auto& self = *static_cast<memory_sampler*>(context);
+      const allocation_statistics& statistics = get_allocation_statistics();
+
+      reset_peak_resident_set_size();
+      self.m_number_of_allocations = statistics.number_of_allocations;
+      self.m_number_of_allocated_bytes = statistics.number_of_allocated_bytes;
+    }
+
+    static void stop(void* const context)
+    {
+      auto& self = *static_cast<memory_sampler*>(context);
+      const allocation_statistics& statistics = get_allocation_statistics();
+
+      self.m_values[0] = static_cast<std::int64_t>(statistics.number_of_allocations - self.m_number_of_allocations);
+      self.m_values[1] =
+        static_cast<std::int64_t>(statistics.number_of_allocated_bytes - self.m_number_of_allocated_bytes);
+      self.m_values[2] = get_peak_resident_set_size();
+    }
+  };
+
+}
+
+#endif
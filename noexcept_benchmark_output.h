@@ -0,0 +1,335 @@
+#ifndef noexcept_benchmark_output_h
+#define noexcept_benchmark_output_h
+
+/*
+Copyright Niels Dekker, LKEB, Leiden University Medical Center
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0.txt
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Machine-readable (JSON and CSV) output of the benchmark results.
+
+#include "noexcept_benchmark_statistics.h"
+#include "noexcept_benchmark_vectorization.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace noexcept_benchmark
+{
+  using name_value_pairs = std::vector<std::pair<std::string, std::string>>;
+
+
+  // The samples of either the noexcept or the implicit variant of a test case.
+  struct variant_record
+  {
+    std::vector<double> durations;
+
+    // Per sample, the values of the hardware counters (if any).
+    std::vector<std::vector<std::int64_t>> counter_values;
+
+    // The size of the test function in the shared library, in bytes, or zero, when unknown.
+    std::uint64_t code_size;
+
+    // Whether the loop of the test function is vectorized, according to the compiler.
+    loop_vectorization vectorization;
+  };
+
+
+  struct test_case_record
+  {
+    std::string id;
+    std::string description;
+    unsigned N;
+
+    // The number of bytes processed per N, or zero, when not applicable.
+    unsigned bytes_per_N;
+    std::vector<std::string> counter_names;
+    variant_record noexcept_variant;
+    variant_record implicit_variant;
+  };
+
+
+  inline std::string to_json_string(const std::string& text)
+  {
+    std::ostringstream stream;
+    stream << '"';
+
+    for (const char c : text)
+    {
+      switch (c)
+      {
+      case '"': stream << "\\\""; break;
+      case '\\': stream << "\\\\"; break;
+      case '\n': stream << "\\n"; break;
+      case '\t': stream << "\\t"; break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20)
+        {
+          const char* const hex_digits = "0123456789abcdef";
+          stream << "\\u00" << hex_digits[(c >> 4) & 0xF] << hex_digits[c & 0xF];
+        }
+        else
+        {
+          stream << c;
+        }
+      }
+    }
+    stream << '"';
+    return stream.str();
+  }
+
+
+  // Formats the number without loss of precision. JSON does not support infinity and NaN.
+  inline std::string to_json_number(const double value)
+  {
+    if (!std::isfinite(value))
+    {
+      return "null";
+    }
+    std::ostringstream stream;
+    stream.precision(std::numeric_limits<double>::max_digits10);
+    stream << value;
+    return stream.str();
+  }
+
+
+  template <typename T>
+  std::string to_json_array(const std::vector<T>& values)
+  {
+    std::string result = "[";
+
+    for (std::size_t i = 0; i < values.size(); ++i)
+    {
+      result += ((i == 0) ? "" : ", ") + to_json_number(static_cast<double>(values[i]));
+    }
+    return result + "]";
+  }
+
+
+  inline void write_json_object(std::ostream& output, const name_value_pairs& pairs, const std::string& indentation)
+  {
+    output << "{";
+
+    for (std::size_t i = 0; i < pairs.size(); ++i)
+    {
+      output << ((i == 0) ? "\n" : ",\n") << indentation << "  "
+        << to_json_string(pairs[i].first) << ": " << to_json_string(pairs[i].second);
+    }
+    output << '\n' << indentation << "}";
+  }
+
+
+  inline void write_json_variant(std::ostream& output, const test_case_record& record, const variant_record& variant)
+  {
+    const sample_summary summary = get_sample_summary(variant.durations);
+
+    output
+      << "{\n"
+      << "          \"durations\": " << to_json_array(variant.durations) << ",\n"
+      << "          \"sum\": " << to_json_number(summary.sum) << ",\n"
+      << "          \"min\": " << to_json_number(summary.minimum) << ",\n"
+      << "          \"median\": " << to_json_number(summary.median) << ",\n"
+      << "          \"percentile25\": " << to_json_number(summary.percentile25) << ",\n"
+      << "          \"percentile75\": " << to_json_number(summary.percentile75) << ",\n"
+      << "          \"median_absolute_deviation\": " << to_json_number(summary.median_absolute_deviation) << ",\n"
+      << "          \"code_size\": " << variant.code_size << ",\n"
+      << "          \"loop_vectorized\": " << ((variant.vectorization == loop_vectorization::unknown) ? "null" :
+        (variant.vectorization == loop_vectorization::vectorized) ? "true" : "false") << ",\n"
+      << "          \"counters\": {";
+
+    for (std::size_t counter_index = 0; counter_index < record.counter_names.size(); ++counter_index)
+    {
+      std::vector<std::int64_t> values;
+
+      for (const std::vector<std::int64_t>& sample_values : variant.counter_values)
+      {
+        values.push_back(sample_values.at(counter_index));
+      }
+      output << ((counter_index == 0) ? "\n" : ",\n")
+        << "            " << to_json_string(record.counter_names[counter_index]) << ": " << to_json_array(values);
+    }
+    output << (record.counter_names.empty() ? "}" : "\n          }") << "\n        }";
+  }
+
+
+  // Writes all samples and their summary statistics, together with the
+  // environment (build and machine) and the settings of the run.
+  inline void write_json(
+    std::ostream& output,
+    const name_value_pairs& environment,
+    const name_value_pairs& settings,
+    const std::vector<test_case_record>& records)
+  {
+    output << "{\n  \"environment\": ";
+    write_json_object(output, environment, "  ");
+    output << ",\n  \"settings\": ";
+    write_json_object(output, settings, "  ");
+    output << ",\n  \"test_cases\": [";
+
+    for (std::size_t i = 0; i < records.size(); ++i)
+    {
+      const test_case_record& record = records[i];
+      const ratio_comparison comparison =
+        get_ratio_comparison(record.implicit_variant.durations, record.noexcept_variant.durations);
+
+      output
+        << ((i == 0) ? "\n" : ",\n")
+        << "    {\n"
+        << "      \"id\": " << to_json_string(record.id) << ",\n"
+        << "      \"description\": " << to_json_string(record.description) << ",\n"
+        << "      \"N\": " << record.N << ",\n"
+        << "      \"bytes_per_N\": " << record.bytes_per_N << ",\n"
+        << "      \"ratio_of_medians\": " << to_json_number(comparison.ratio_of_medians) << ",\n"
+        << "      \"ratio_interval\": [" << to_json_number(comparison.ratio_interval.lower)
+        << ", " << to_json_number(comparison.ratio_interval.upper) << "],\n"
+        << "      \"p_value\": " << to_json_number(comparison.p_value) << ",\n"
+        << "      \"variants\": {\n"
+        << "        \"noexcept\": ";
+      write_json_variant(output, record, record.noexcept_variant);
+      output << ",\n        \"implicit\": ";
+      write_json_variant(output, record, record.implicit_variant);
+      output << "\n      }\n    }";
+    }
+    output << (records.empty() ? "]" : "\n  ]") << "\n}\n";
+  }
+
+
+  inline std::string to_csv_field(const std::string& text)
+  {
+    if (text.find_first_of(",\"\n") == std::string::npos)
+    {
+      return text;
+    }
+    std::string result = "\"";
+
+    for (const char c : text)
+    {
+      result += (c == '"') ? "\"\"" : std::string(1, c);
+    }
+    return result + "\"";
+  }
+
+
+  // Writes a row per sample, followed by a row per summary statistic, for which
+  // the "sample" column holds the name of the statistic. The environment is
+  // repeated on each row, so that rows of different runs can be concatenated.
+  inline void write_csv(
+    std::ostream& output,
+    const name_value_pairs& environment,
+    const std::vector<test_case_record>& records)
+  {
+    std::vector<std::string> counter_names;
+
+    for (const test_case_record& record : records)
+    {
+      for (const std::string& name : record.counter_names)
+      {
+        if (std::find(counter_names.cbegin(), counter_names.cend(), name) == counter_names.cend())
+        {
+          counter_names.push_back(name);
+        }
+      }
+    }
+
+    for (const auto& pair : environment)
+    {
+      output << to_csv_field(pair.first) << ',';
+    }
+    output << "id,description,N,ratio_of_medians,ratio_interval_lower,ratio_interval_upper,p_value,"
+      "code_size_noexcept,code_size_implicit,sample,duration_noexcept,duration_implicit";
+
+    for (const std::string& name : counter_names)
+    {
+      output << ',' << to_csv_field(name + "_noexcept") << ',' << to_csv_field(name + "_implicit");
+    }
+    output << '\n';
+
+    for (const test_case_record& record : records)
+    {
+      const ratio_comparison comparison =
+        get_ratio_comparison(record.implicit_variant.durations, record.noexcept_variant.durations);
+
+      std::string row_prefix;
+
+      for (const auto& pair : environment)
+      {
+        row_prefix += to_csv_field(pair.second) + ',';
+      }
+      row_prefix += to_csv_field(record.id) + ',' + to_csv_field(record.description) + ',' +
+        std::to_string(record.N) + ',' + to_json_number(comparison.ratio_of_medians) + ',' +
+        to_json_number(comparison.ratio_interval.lower) + ',' + to_json_number(comparison.ratio_interval.upper) + ',' +
+        to_json_number(comparison.p_value) + ',' + std::to_string(record.noexcept_variant.code_size) + ',' +
+        std::to_string(record.implicit_variant.code_size) + ',';
+
+      for (std::size_t sample_index = 0; sample_index < record.noexcept_variant.durations.size(); ++sample_index)
+      {
+        output << row_prefix << sample_index << ','
+          << to_json_number(record.noexcept_variant.durations[sample_index]) << ','
+          << to_json_number(record.implicit_variant.durations[sample_index]);
+
+        for (const std::string& name : counter_names)
+        {
+          const auto counter_index = static_cast<std::size_t>(std::find(record.counter_names.cbegin(),
+            record.counter_names.cend(), name) - record.counter_names.cbegin());
+          const bool has_values = (counter_index < record.counter_names.size()) &&
+            (sample_index < record.noexcept_variant.counter_values.size());
+
+          output << ',';
+          if (has_values)
+          {
+            output << record.noexcept_variant.counter_values[sample_index][counter_index] << ','
+              << record.implicit_variant.counter_values[sample_index][counter_index];
+          }
+          else
+          {
+            output << ',';
+          }
+        }
+        output << '\n';
+      }
+
+      const sample_summary summary_noexcept = get_sample_summary(record.noexcept_variant.durations);
+      const sample_summary summary_implicit = get_sample_summary(record.implicit_variant.durations);
+      const std::pair<const char*, double sample_summary::*> statistics[] =
+      {
+        { "sum", &sample_summary::sum },
+        { "min", &sample_summary::minimum },
+        { "median", &sample_summary::median },
+        { "percentile25", &sample_summary::percentile25 },
+        { "percentile75", &sample_summary::percentile75 },
+        { "median_absolute_deviation", &sample_summary::median_absolute_deviation }
+      };
+
+      for (const auto& statistic : statistics)
+      {
+        output << row_prefix << statistic.first << ','
+          << to_json_number(summary_noexcept.*statistic.second) << ','
+          << to_json_number(summary_implicit.*statistic.second)
+          << std::string(2 * counter_names.size(), ',') << '\n';
+      }
+    }
+  }
+
+}
+
+#endif
@@ -0,0 +1,329 @@
+#ifndef noexcept_benchmark_pages_h
+#define noexcept_benchmark_pages_h
+
+/*
+Copyright Niels Dekker, LKEB, Leiden University Medical Center
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0.txt
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Memory that is allocated directly by the OS (mmap), for the large-memory
+// test cases: optionally backed by transparent huge pages (MADV_HUGEPAGE) or
+// explicit huge pages (MAP_HUGETLB), pre-faulted, and placed on the NUMA nodes
+// by a memory policy (mbind), as specified by --huge-pages, --prefault and
+// --numa. Only supported on Linux.
+
+#include "noexcept_benchmark.h"
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#ifdef __linux__
+#  include <algorithm>
+#  include <fstream>
+#  include <sstream>
+#  include <string>
+#  include <vector>
+#  include <sys/mman.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#endif
+
+
+namespace noexcept_benchmark
+{
+  enum class huge_page_mode : unsigned
+  {
+    none,
+    transparent,
+    explicit_huge_pages
+  };
+
+  enum class numa_placement : unsigned
+  {
+    // The default policy of the process: typically on the node of the CPU that first touches a page.
+    first_touch,
+    local,
+    interleave
+  };
+
+
+  struct memory_placement
+  {
+    huge_page_mode huge_pages = huge_page_mode::none;
+    numa_placement numa = numa_placement::first_touch;
+    bool prefault = false;
+
+    bool is_specified() const
+    {
+      return (huge_pages != huge_page_mode::none) || (numa != numa_placement::first_touch) || prefault;
+    }
+  };
+
+
+  // The memory placement of the current module (the executable or a lib). Each
+  // lib exports set_memory_placement, to set its own.
+  inline memory_placement& get_memory_placement()
+  {
+    static memory_placement placement;
+    return placement;
+  }
+
+
+  // Assumes the default huge page size of x86-64 and AArch64 (with 4 KiB base pages).
+  const std::size_t huge_page_size = std::size_t{ 1 } << 21;
+  const std::size_t base_page_size = std::size_t{ 1 } << 12;
+
+
+  inline std::size_t round_up_to_huge_pages(const std::size_t number_of_bytes)
+  {
+    return (number_of_bytes + huge_page_size - 1) / huge_page_size * huge_page_size;
+  }
+
+
+#ifdef __linux__
+  // Returns the node mask of the online NUMA nodes, as listed by
+  // /sys/devices/system/node/online (like "0-3,6"), or of node 0 only, when
+  // that file cannot be read. Unlike a mask with all bits set, it is accepted
+  // by mbind, regardless of the maximum number of nodes of the kernel.
+  inline const std::vector<unsigned long>& get_online_numa_nodes()
+  {
+    static const std::vector<unsigned long> nodes = []
+    {
+      const unsigned bits_per_word = 8 * sizeof(unsigned long);
+      std::vector<unsigned long> result;
+      std::ifstream file("/sys/devices/system/node/online");
+      std::string ranges;
+      std::getline(file, ranges);
+      std::istringstream stream{ ranges };
+      std::string range;
+
+      while (std::getline(stream, range, ','))
+      {
+        std::istringstream range_stream{ range };
+        unsigned first = 0;
+        char dash = '\0';
+
+        if (range_stream >> first)
+        {
+          unsigned last = first;
+
+          if ((range_stream >> dash >> last) && (dash != '-'))
+          {
+            continue;
+          }
+          for (unsigned node = first; node <= last; ++node)
+          {
+            result.resize(std::max<std::size_t>(result.size(), node / bits_per_word + 1));
+            result[node / bits_per_word] |= 1UL << (node % bits_per_word);
+          }
+        }
+      }
+      if (result.empty())
+      {
+        result.push_back(1UL);
+      }
+      return result;
+    }();
+    return nodes;
+  }
+#endif
+
+
+  // Returns the allocated memory, or null, when the allocation (or setting its
+  // memory policy) has failed.
+  inline void* allocate_pages(const std::size_t number_of_bytes, const memory_placement& placement)
+  {
+#ifdef __linux__
+    const std::size_t size = round_up_to_huge_pages(number_of_bytes);
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+
+    if (placement.huge_pages == huge_page_mode::explicit_huge_pages)
+    {
+      flags |= MAP_HUGETLB;
+    }
+    void* const result = mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+
+    if (result == MAP_FAILED)
+    {
+      return nullptr;
+    }
+    if ((placement.huge_pages == huge_page_mode::transparent) && (madvise(result, size, MADV_HUGEPAGE) != 0))
+    {
+      munmap(result, size);
+      return nullptr;
+    }
+    if (placement.numa != numa_placement::first_touch)
+    {
+      // The values of MPOL_INTERLEAVE and MPOL_LOCAL from <numaif.h> (libnuma),
+      // which is not a dependency. Interleaved over all the online nodes. Like
+      // libnuma, passes one more than the number of bits of the node mask as
+      // maxnode, as the kernel ignores its last bit.
+      const int mpol_interleave = 3;
+      const int mpol_local = 4;
+      const std::vector<unsigned long>& online_nodes = get_online_numa_nodes();
+      const bool is_interleaved = placement.numa == numa_placement::interleave;
+
+      if (syscall(SYS_mbind, result, size, is_interleaved ? mpol_interleave : mpol_local,
+        is_interleaved ? online_nodes.data() : nullptr,
+        is_interleaved ? (8 * sizeof(unsigned long) * online_nodes.size() + 1) : 0, 0) != 0)
+      {
+        munmap(result, size);
+        return nullptr;
+      }
+    }
+    if (placement.prefault)
+    {
+      // Touches each page, after setting its memory policy.
+      volatile char* const bytes = static_cast<char*>(result);
+
+      for (std::size_t i = 0; i < size; i += base_page_size)
+      {
+        bytes[i] = 0;
+      }
+    }
+    return result;
+#else
+    (void)placement;
+    return ::operator new(number_of_bytes, std::nothrow);
+#endif
+  }
+
+
+  inline void deallocate_pages(void* const pages, const std::size_t number_of_bytes)
+  {
+#ifdef __linux__
+    munmap(pages, round_up_to_huge_pages(number_of_bytes));
+#else
+    (void)number_of_bytes;
+    ::operator delete(pages);
+#endif
+  }
+
+
+  // Like allocate_pages, as specified by get_memory_placement(), but throws
+  // std::bad_alloc (or aborts, without exceptions) when the allocation fails.
+  inline void* allocate_placed_pages(const std::size_t number_of_bytes)
+  {
+    void* const pages = allocate_pages(number_of_bytes, get_memory_placement());
+
+    if (pages == nullptr)
+    {
+#if NOEXCEPT_BENCHMARK_HAS_EXCEPTIONS
+      throw std::bad_alloc{};
+#else
+      std::abort();
+#endif
+    }
+    return pages;
+  }
+
+
+  // Pages that are allocated in advance (and pre-faulted, by --prefault), before
+  // the timed code, to be taken by the next page_allocator allocation of the
+  // same size, so that neither their allocation nor their page faults are timed.
+  struct page_reservation
+  {
+    void* pages = nullptr;
+    std::size_t number_of_bytes = 0;
+  };
+
+
+  inline page_reservation& get_page_reservation()
+  {
+    static page_reservation reservation;
+    return reservation;
+  }
+
+
+  inline void release_reserved_pages()
+  {
+    page_reservation& reservation = get_page_reservation();
+
+    if (reservation.pages != nullptr)
+    {
+      deallocate_pages(reservation.pages, reservation.number_of_bytes);
+      reservation = page_reservation{};
+    }
+  }
+
+
+  inline void reserve_pages(const std::size_t number_of_bytes)
+  {
+    release_reserved_pages();
+    page_reservation& reservation = get_page_reservation();
+    reservation.pages = allocate_placed_pages(number_of_bytes);
+    reservation.number_of_bytes = number_of_bytes;
+  }
+
+
+  // Returns the reserved pages, when they have the specified size (rounded up
+  // to huge pages), and null otherwise.
+  inline void* take_reserved_pages(const std::size_t number_of_bytes)
+  {
+    page_reservation& reservation = get_page_reservation();
+
+    if ((reservation.pages == nullptr) ||
+      (round_up_to_huge_pages(reservation.number_of_bytes) != round_up_to_huge_pages(number_of_bytes)))
+    {
+      return nullptr;
+    }
+    void* const result = reservation.pages;
+    reservation = page_reservation{};
+    return result;
+  }
+
+
+  // A standard allocator that allocates by allocate_pages, for example, for
+  // the buffer of an std::vector, as specified by get_memory_placement(). Takes
+  // the reserved pages (from reserve_pages), when they have the requested size.
+  template <typename T>
+  struct page_allocator
+  {
+    using value_type = T;
+
+    page_allocator() = default;
+
+    template <typename U>
+    page_allocator(const page_allocator<U>&)
+    {
+    }
+
+    T* allocate(const std::size_t n)
+    {
+      void* const reserved_pages = take_reserved_pages(n * sizeof(T));
+      return static_cast<T*>((reserved_pages == nullptr) ? allocate_placed_pages(n * sizeof(T)) : reserved_pages);
+    }
+
+    void deallocate(T* const p, const std::size_t n)
+    {
+      deallocate_pages(p, n * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const page_allocator<U>&) const
+    {
+      return true;
+    }
+
+    template <typename U>
+    bool operator!=(const page_allocator<U>&) const
+    {
+      return false;
+    }
+  };
+
+}
+
+#endif
@@ -0,0 +1,132 @@
+#ifndef noexcept_benchmark_plugin_h
+#define noexcept_benchmark_plugin_h
+
+/*
+Copyright Niels Dekker, LKEB, Leiden University Medical Center
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0.txt
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// A lib that is loaded at run-time, by dlopen or LoadLibrary, rather than
+// linked to the executable. It may be built by another compiler (or compiler
+// version), as long as it exports noexcept_benchmark_get_lib_descriptor.
+
+#include "noexcept_benchmark.h"
+
+#include <string>
+
+#ifdef _WIN32
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#else
+#  include <dlfcn.h>
+#endif
+
+
+namespace noexcept_benchmark
+{
+  class plugin_lib
+  {
+  public:
+    // Loads the shared library from the specified file, and retrieves its descriptor.
+    explicit plugin_lib(const std::string& file_name)
+    {
+#ifdef _WIN32
+      m_handle = LoadLibraryA(file_name.c_str());
+
+      if (m_handle == nullptr)
+      {
+        m_error_message = "Failed to load \"" + file_name + "\" (error code " + std::to_string(GetLastError()) + ")";
+        return;
+      }
+      const auto get_lib_descriptor = reinterpret_cast<get_lib_descriptor_type>(
+        GetProcAddress(m_handle, NOEXCEPT_BENCHMARK_GET_LIB_DESCRIPTOR_FUNC_NAME));
+#else
+      // RTLD_DEEPBIND lets the lib use its own functions, rather than those of
+      // the libs that are linked to the executable, which have the same names.
+      int flags = RTLD_NOW | RTLD_LOCAL;
+#  ifdef RTLD_DEEPBIND
+      flags |= RTLD_DEEPBIND;
+#  endif
+      m_handle = dlopen(file_name.c_str(), flags);
+
+      if (m_handle == nullptr)
+      {
+        const char* const error = dlerror();
+        m_error_message = "Failed to load \"" + file_name + "\": " + ((error == nullptr) ? "unknown error" : error);
+        return;
+      }
+      const auto get_lib_descriptor = reinterpret_cast<get_lib_descriptor_type>(
+        dlsym(m_handle, NOEXCEPT_BENCHMARK_GET_LIB_DESCRIPTOR_FUNC_NAME));
+#endif
+      if (get_lib_descriptor == nullptr)
+      {
+        m_error_message = "\"" + file_name + "\" does not export " NOEXCEPT_BENCHMARK_GET_LIB_DESCRIPTOR_FUNC_NAME;
+        return;
+      }
+
+      const lib_descriptor* const descriptor = get_lib_descriptor();
+
+      if ((descriptor == nullptr) || (descriptor->version != NOEXCEPT_BENCHMARK_LIB_DESCRIPTOR_VERSION))
+      {
+        m_error_message = "\"" + file_name + "\" has an incompatible lib descriptor version (expected version "
+          + std::to_string(NOEXCEPT_BENCHMARK_LIB_DESCRIPTOR_VERSION) + ")";
+        return;
+      }
+      m_descriptor = descriptor;
+    }
+
+    ~plugin_lib()
+    {
+      if (m_handle != nullptr)
+      {
+#ifdef _WIN32
+        FreeLibrary(m_handle);
+#else
+        dlclose(m_handle);
+#endif
+      }
+    }
+
+    plugin_lib(const plugin_lib&) = delete;
+    plugin_lib& operator=(const plugin_lib&) = delete;
+
+    // The descriptor of the lib, or null, when it failed to load.
+    const lib_descriptor* get_descriptor() const
+    {
+      return m_descriptor;
+    }
+
+    // Empty, when the lib is loaded successfully.
+    const std::string& get_error_message() const
+    {
+      return m_error_message;
+    }
+
+  private:
+    using get_lib_descriptor_type = const lib_descriptor* (*)();
+
+#ifdef _WIN32
+    HMODULE m_handle = nullptr;
+#else
+    void* m_handle = nullptr;
+#endif
+    const lib_descriptor* m_descriptor = nullptr;
+    std::string m_error_message;
+  };
+
+}
+
+#endif
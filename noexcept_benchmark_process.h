@@ -0,0 +1,104 @@
+#ifndef noexcept_benchmark_process_h
+#define noexcept_benchmark_process_h
+
+/*
+Copyright Niels Dekker, LKEB, Leiden University Medical Center
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0.txt
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Runs a command in a child process (by popen, or _popen on Windows), and
+// reads its standard output through a pipe, line by line. Used by --isolate,
+// to run each test case in a fresh process.
+
+#include <cstdio>
+#include <string>
+
+#ifdef _WIN32
+#  define NOEXCEPT_BENCHMARK_POPEN _popen
+#  define NOEXCEPT_BENCHMARK_PCLOSE _pclose
+#else
+#  include <sys/wait.h>
+#  define NOEXCEPT_BENCHMARK_POPEN popen
+#  define NOEXCEPT_BENCHMARK_PCLOSE pclose
+#endif
+
+
+namespace noexcept_benchmark
+{
+  // Quotes the argument for the command interpreter (the shell, or cmd.exe),
+  // so that it is passed unchanged to the command. On Windows, the argument
+  // should not contain any double quotes.
+  inline std::string quote_command_argument(const std::string& arg)
+  {
+#ifdef _WIN32
+    return '"' + arg + '"';
+#else
+    std::string result = "'";
+
+    for (const char c : arg)
+    {
+      result += (c == '\'') ? std::string("'\\''") : std::string(1, c);
+    }
+    return result + "'";
+#endif
+  }
+
+
+  // Runs the command, and passes each line of its standard output (without
+  // the newline) to the specified function. Returns the exit code of the
+  // command, or -1 when it could not be run.
+  template <typename T>
+  int run_command(const std::string& command, T process_line)
+  {
+#ifdef _WIN32
+    // cmd.exe strips the outer quotes of a command that starts with a quote.
+    FILE* const pipe = NOEXCEPT_BENCHMARK_POPEN(('"' + command + '"').c_str(), "r");
+#else
+    FILE* const pipe = NOEXCEPT_BENCHMARK_POPEN(command.c_str(), "r");
+#endif
+
+    if (pipe == nullptr)
+    {
+      return -1;
+    }
+    std::string line;
+    char buffer[4096];
+
+    while (std::fgets(buffer, sizeof(buffer), pipe) != nullptr)
+    {
+      line += buffer;
+
+      if (!line.empty() && (line.back() == '\n'))
+      {
+        line.pop_back();
+        process_line(line);
+        line.clear();
+      }
+    }
+    if (!line.empty())
+    {
+      process_line(line);
+    }
+    const int status = NOEXCEPT_BENCHMARK_PCLOSE(pipe);
+
+#ifdef _WIN32
+    return status;
+#else
+    return ((status != -1) && WIFEXITED(status)) ? WEXITSTATUS(status) : -1;
+#endif
+  }
+
+}
+
+#endif
@@ -0,0 +1,253 @@
+#ifndef noexcept_benchmark_statistics_h
+#define noexcept_benchmark_statistics_h
+
+/*
+Copyright Niels Dekker, LKEB, Leiden University Medical Center
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0.txt
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <utility>
+#include <vector>
+
+
+namespace noexcept_benchmark
+{
+  // Returns the p-th percentile (0 <= p <= 100) of the samples, linearly
+  // interpolating between the two nearest ranks.
+  inline double get_percentile(std::vector<double> samples, const double p)
+  {
+    assert(!samples.empty());
+    std::sort(samples.begin(), samples.end());
+
+    const double rank = (p / 100.0) * static_cast<double>(samples.size() - 1);
+    const auto lower_index = static_cast<std::size_t>(std::floor(rank));
+    const auto upper_index = std::min(lower_index + 1, samples.size() - 1);
+    const double fraction = rank - static_cast<double>(lower_index);
+
+    return samples[lower_index] + fraction * (samples[upper_index] - samples[lower_index]);
+  }
+
+
+  inline double get_median(std::vector<double> samples)
+  {
+    return get_percentile(std::move(samples), 50.0);
+  }
+
+
+  inline double get_median_absolute_deviation(const std::vector<double>& samples)
+  {
+    const double median = get_median(samples);
+    std::vector<double> deviations;
+    deviations.reserve(samples.size());
+
+    for (const double sample : samples)
+    {
+      deviations.push_back(std::abs(sample - median));
+    }
+    return get_median(std::move(deviations));
+  }
+
+
+  struct sample_summary
+  {
+    double sum;
+    double minimum;
+    double median;
+    double percentile25;
+    double percentile75;
+    double median_absolute_deviation;
+  };
+
+
+  inline sample_summary get_sample_summary(const std::vector<double>& samples)
+  {
+    assert(!samples.empty());
+    return
+    {
+      std::accumulate(samples.cbegin(), samples.cend(), 0.0),
+      *std::min_element(samples.cbegin(), samples.cend()),
+      get_median(samples),
+      get_percentile(samples, 25.0),
+      get_percentile(samples, 75.0),
+      get_median_absolute_deviation(samples)
+    };
+  }
+
+
+  struct confidence_interval
+  {
+    double lower;
+    double upper;
+  };
+
+
+  // Estimates a confidence interval on the ratio of the medians of two paired
+  // sample sets, numerators[i]/denominators[i], by bootstrap resampling of the pairs.
+  // Uses a fixed seed, so that the interval is reproducible for the same samples.
+  inline confidence_interval get_bootstrap_median_ratio_interval(
+    const std::vector<double>& numerators,
+    const std::vector<double>& denominators,
+    const double confidence_level = 0.95,
+    const unsigned number_of_resamples = 2000)
+  {
+    assert(!numerators.empty());
+    assert(numerators.size() == denominators.size());
+
+    const std::size_t number_of_samples = numerators.size();
+    std::mt19937 random_engine;
+    std::uniform_int_distribution<std::size_t> distribution(0, number_of_samples - 1);
+    std::vector<double> resampled_numerators(number_of_samples);
+    std::vector<double> resampled_denominators(number_of_samples);
+    std::vector<double> ratios;
+    ratios.reserve(number_of_resamples);
+
+    for (unsigned resample_number = 0; resample_number < number_of_resamples; ++resample_number)
+    {
+      for (std::size_t i = 0; i < number_of_samples; ++i)
+      {
+        const std::size_t index = distribution(random_engine);
+        resampled_numerators[i] = numerators[index];
+        resampled_denominators[i] = denominators[index];
+      }
+      const double median_denominator = get_median(resampled_denominators);
+
+      if (median_denominator > 0.0)
+      {
+        ratios.push_back(get_median(resampled_numerators) / median_denominator);
+      }
+    }
+
+    if (ratios.empty())
+    {
+      return { 0.0, 0.0 };
+    }
+    const double tail_percentage = 50.0 * (1.0 - confidence_level);
+    return { get_percentile(ratios, tail_percentage), get_percentile(ratios, 100.0 - tail_percentage) };
+  }
+
+
+  // Two-sided Mann-Whitney U test, using the normal approximation with tie and
+  // continuity correction. Returns the p-value of the null hypothesis that both
+  // sample sets come from the same distribution.
+  inline double get_mann_whitney_p_value(const std::vector<double>& x, const std::vector<double>& y)
+  {
+    const std::size_t n1 = x.size();
+    const std::size_t n2 = y.size();
+    const std::size_t n = n1 + n2;
+
+    if ((n1 == 0) || (n2 == 0))
+    {
+      return 1.0;
+    }
+
+    struct ranked_sample
+    {
+      double value;
+      bool is_from_x;
+    };
+    std::vector<ranked_sample> combined;
+    combined.reserve(n);
+
+    for (const double value : x)
+    {
+      combined.push_back({ value, true });
+    }
+    for (const double value : y)
+    {
+      combined.push_back({ value, false });
+    }
+    std::sort(combined.begin(), combined.end(),
+      [](const ranked_sample& lhs, const ranked_sample& rhs)
+    {
+      return lhs.value < rhs.value;
+    });
+
+    double sum_of_ranks_x = 0.0;
+    double tie_correction = 0.0;
+
+    for (std::size_t begin = 0; begin < n;)
+    {
+      std::size_t end = begin + 1;
+
+      while ((end < n) && (combined[end].value == combined[begin].value))
+      {
+        ++end;
+      }
+      // Tied samples all get the average of their (one-based) ranks.
+      const double average_rank = 0.5 * static_cast<double>(begin + 1 + end);
+      const auto number_of_ties = static_cast<double>(end - begin);
+
+      for (std::size_t i = begin; i < end; ++i)
+      {
+        if (combined[i].is_from_x)
+        {
+          sum_of_ranks_x += average_rank;
+        }
+      }
+      tie_correction += number_of_ties * number_of_ties * number_of_ties - number_of_ties;
+      begin = end;
+    }
+
+    const double dn1 = static_cast<double>(n1);
+    const double dn2 = static_cast<double>(n2);
+    const double dn = static_cast<double>(n);
+    const double u = sum_of_ranks_x - dn1 * (dn1 + 1.0) / 2.0;
+    const double mean_u = dn1 * dn2 / 2.0;
+    const double variance_u = (dn1 * dn2 / 12.0) * ((dn + 1.0) - tie_correction / (dn * (dn - 1.0)));
+
+    if (!(variance_u > 0.0))
+    {
+      return 1.0;
+    }
+    const double z = std::max(std::abs(u - mean_u) - 0.5, 0.0) / std::sqrt(variance_u);
+    return std::erfc(z / std::sqrt(2.0));
+  }
+
+
+
+  struct ratio_comparison
+  {
+    double ratio_of_medians;
+    confidence_interval ratio_interval;
+    double p_value;
+  };
+
+
+  // Compares the paired sample sets by the ratio of their medians,
+  // numerators/denominators, and the Mann-Whitney U test.
+  inline ratio_comparison get_ratio_comparison(
+    const std::vector<double>& numerators,
+    const std::vector<double>& denominators)
+  {
+    const double median_denominator = get_median(denominators);
+
+    return
+    {
+      get_median(numerators) /
+        ((median_denominator > 0.0) ? median_denominator : std::numeric_limits<double>::denorm_min()),
+      get_bootstrap_median_ratio_interval(numerators, denominators),
+      get_mann_whitney_p_value(numerators, denominators)
+    };
+  }
+
+}
+
+#endif
@@ -0,0 +1,180 @@
+#ifndef noexcept_benchmark_threads_h
+#define noexcept_benchmark_threads_h
+
+/*
+Copyright Niels Dekker, LKEB, Leiden University Medical Center
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0.txt
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Runs a test function on multiple threads concurrently, to measure the
+// effect of contention, for example on the global locks of the unwinder.
+
+#include "noexcept_benchmark_affinity.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#else
+#  include <pthread.h>
+#endif
+
+
+namespace noexcept_benchmark
+{
+  // A single-use barrier: the threads spin until all of them have arrived,
+  // so that they start at (nearly) the same time, without waiting to be woken
+  // up by the scheduler, as they would with a condition variable. They do yield
+  // while spinning, as there may be more threads than CPUs.
+  class start_barrier
+  {
+    std::atomic<std::size_t> m_number_of_arrived_threads{ 0 };
+    const std::size_t m_number_of_threads;
+
+  public:
+    explicit start_barrier(const std::size_t number_of_threads)
+      :
+      m_number_of_threads{ number_of_threads }
+    {
+    }
+
+    void arrive_and_wait()
+    {
+      ++m_number_of_arrived_threads;
+
+      while (m_number_of_arrived_threads.load() < m_number_of_threads)
+      {
+        std::this_thread::yield();
+      }
+    }
+  };
+
+
+  struct concurrent_sample
+  {
+    // From the earliest start of a thread (after the start barrier) until the
+    // latest end of a thread.
+    double wall_clock_duration;
+
+    // The duration measured by each thread, by its own call.
+    std::vector<double> thread_durations;
+  };
+
+
+  // Calls func(N) on each of the specified number of threads, all starting at
+  // the same time. Thread i is pinned to CPU (first_cpu_index + i), modulo the
+  // number of CPUs, so that the threads do not migrate between CPUs, and do
+  // not share a CPU (unless there are more threads than CPUs).
+  inline concurrent_sample run_concurrently(
+    double (* const func)(unsigned),
+    const unsigned N,
+    const unsigned number_of_threads,
+    const unsigned first_cpu_index)
+  {
+    using namespace std::chrono;
+
+    const unsigned number_of_cpus = std::max(std::thread::hardware_concurrency(), 1U);
+    concurrent_sample result{ 0.0, std::vector<double>(number_of_threads) };
+    std::vector<steady_clock::time_point> start_times(number_of_threads);
+    std::vector<steady_clock::time_point> end_times(number_of_threads);
+    start_barrier barrier(number_of_threads);
+    std::vector<std::thread> threads;
+
+    for (unsigned thread_index = 0; thread_index < number_of_threads; ++thread_index)
+    {
+      threads.emplace_back([=, &barrier, &result, &start_times, &end_times]
+      {
+        pin_current_thread((first_cpu_index + thread_index) % number_of_cpus);
+        barrier.arrive_and_wait();
+
+        // Each thread has its own start and end time, as a thread may already
+        // be finished before another thread has left the barrier.
+        start_times[thread_index] = steady_clock::now();
+        result.thread_durations[thread_index] = func(N);
+        end_times[thread_index] = steady_clock::now();
+      });
+    }
+    for (std::thread& thread : threads)
+    {
+      thread.join();
+    }
+    if (number_of_threads > 0)
+    {
+      result.wall_clock_duration = duration_cast<duration<double>>(
+        *std::max_element(end_times.cbegin(), end_times.cend()) -
+        *std::min_element(start_times.cbegin(), start_times.cend())).count();
+    }
+    return result;
+  }
+
+
+  // Calls func() on a new thread, whose stack has the specified size (in
+  // bytes), and waits for it to finish. Unlike std::thread, it allows a stack
+  // that is much larger than the default. Returns false when the thread could
+  // not be created.
+  template <typename T>
+  bool run_on_thread_with_stack_size(const std::size_t stack_size, T& func)
+  {
+#ifdef _WIN32
+    const auto thread_procedure = [](const LPVOID parameter) -> DWORD
+    {
+      (*static_cast<T*>(parameter))();
+      return 0;
+    };
+    const HANDLE thread_handle = CreateThread(nullptr, stack_size, thread_procedure, &func,
+      STACK_SIZE_PARAM_IS_A_RESERVATION, nullptr);
+
+    if (thread_handle == nullptr)
+    {
+      return false;
+    }
+    WaitForSingleObject(thread_handle, INFINITE);
+    CloseHandle(thread_handle);
+    return true;
+#else
+    pthread_attr_t attributes;
+
+    if (pthread_attr_init(&attributes) != 0)
+    {
+      return false;
+    }
+    pthread_t thread;
+    const bool is_created = (pthread_attr_setstacksize(&attributes, stack_size) == 0) &&
+      (pthread_create(&thread, &attributes, [](void* const parameter) -> void*
+      {
+        (*static_cast<T*>(parameter))();
+        return nullptr;
+      }, &func) == 0);
+
+    pthread_attr_destroy(&attributes);
+
+    if (is_created)
+    {
+      pthread_join(thread, nullptr);
+    }
+    return is_created;
+#endif
+  }
+
+}
+
+#endif
@@ -0,0 +1,403 @@
+#ifndef noexcept_benchmark_timer_h
+#define noexcept_benchmark_timer_h
+
+/*
+Copyright Niels Dekker, LKEB, Leiden University Medical Center
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0.txt
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Timer policies for noexcept_benchmark::profile_func_call. Each timer policy
+// has a static start() and stop() member function, both returning a tick count,
+// a static get_seconds_per_tick(), and a static calibrate(), which estimates
+// the timer_calibration that its get_seconds_per_tick() may need.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#  define NOEXCEPT_BENCHMARK_HAS_TSC_TIMER 1
+#  ifdef _MSC_VER
+#    include <intrin.h>
+#  else
+#    include <x86intrin.h>
+#  endif
+#endif
+
+#if defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+#  define NOEXCEPT_BENCHMARK_HAS_CNTVCT_TIMER 1
+#endif
+
+#ifdef __linux__
+#  define NOEXCEPT_BENCHMARK_HAS_PERF_EVENT_TIMER 1
+#  include <linux/perf_event.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#  include <cstring>
+#  include <iostream>
+#endif
+
+
+namespace noexcept_benchmark
+{
+  // The calibration of a timer policy, for the current module (the executable
+  // or a lib). The executable estimates the calibration of the default timer
+  // once, by its calibrate(), before taking any sample, and hands it to each
+  // lib by its exported set_timer_calibration. So all modules convert their
+  // ticks to seconds by the same factor, and perf_event_timer makes the same
+  // fallback decision in each of them.
+  struct timer_calibration
+  {
+    double seconds_per_tick = 0.0;
+
+    // Only for perf_event_timer: whether its CPU cycle counter is available.
+    bool is_counter_available = false;
+  };
+
+
+  template <typename Timer>
+  timer_calibration& get_timer_calibration()
+  {
+    static timer_calibration calibration;
+    return calibration;
+  }
+
+
+  struct chrono_timer
+  {
+    using clock_type = std::chrono::high_resolution_clock;
+
+    static std::int64_t start()
+    {
+      return clock_type::now().time_since_epoch().count();
+    }
+
+    static std::int64_t stop()
+    {
+      return clock_type::now().time_since_epoch().count();
+    }
+
+    static double get_seconds_per_tick()
+    {
+      return static_cast<double>(clock_type::period::num) / clock_type::period::den;
+    }
+
+    static timer_calibration calibrate()
+    {
+      timer_calibration result;
+      result.seconds_per_tick = get_seconds_per_tick();
+      return result;
+    }
+  };
+
+
+  // Estimates the duration of a tick of the specified counter, by comparing
+  // it to std::chrono::steady_clock during a short busy wait.
+  template <typename T>
+  double estimate_seconds_per_tick(T read_counter)
+  {
+    using namespace std::chrono;
+
+    const auto calibration_duration = milliseconds(20);
+    const auto time_point1 = steady_clock::now();
+    const auto counter1 = read_counter();
+    auto time_point2 = time_point1;
+
+    while (time_point2 - time_point1 < calibration_duration)
+    {
+      time_point2 = steady_clock::now();
+    }
+    const auto counter2 = read_counter();
+
+    return duration_cast<duration<double>>(time_point2 - time_point1).count() /
+      static_cast<double>(std::max<std::int64_t>(counter2 - counter1, 1));
+  }
+
+
+#ifdef NOEXCEPT_BENCHMARK_HAS_TSC_TIMER
+  // Reads the time stamp counter, serialized against the timed code, as
+  // recommended by Intel's "How to Benchmark Code Execution Times" (2010).
+  struct tsc_timer
+  {
+    static std::int64_t start()
+    {
+      _mm_lfence();
+      const auto result = static_cast<std::int64_t>(__rdtsc());
+      _mm_lfence();
+      return result;
+    }
+
+    static std::int64_t stop()
+    {
+      unsigned aux;
+      const auto result = static_cast<std::int64_t>(__rdtscp(&aux));
+      _mm_lfence();
+      return result;
+    }
+
+    static double get_seconds_per_tick()
+    {
+      return get_timer_calibration<tsc_timer>().seconds_per_tick;
+    }
+
+    static timer_calibration calibrate()
+    {
+      timer_calibration result;
+      result.seconds_per_tick = estimate_seconds_per_tick(stop);
+      return result;
+    }
+  };
+#endif
+
+
+#ifdef NOEXCEPT_BENCHMARK_HAS_CNTVCT_TIMER
+  // Reads the AArch64 virtual counter. The instruction synchronization barrier
+  // prevents it from being read speculatively, out of order.
+  struct cntvct_timer
+  {
+    static std::int64_t start()
+    {
+      std::uint64_t result;
+      asm volatile("isb; mrs %0, cntvct_el0" : "=r"(result) : : "memory");
+      return static_cast<std::int64_t>(result);
+    }
+
+    static std::int64_t stop()
+    {
+      return start();
+    }
+
+    static double get_seconds_per_tick()
+    {
+      std::uint64_t frequency;
+      asm volatile("mrs %0, cntfrq_el0" : "=r"(frequency));
+      return 1.0 / static_cast<double>(frequency);
+    }
+
+    static timer_calibration calibrate()
+    {
+      timer_calibration result;
+      result.seconds_per_tick = get_seconds_per_tick();
+      return result;
+    }
+  };
+#endif
+
+
+#ifdef NOEXCEPT_BENCHMARK_HAS_PERF_EVENT_TIMER
+  // Counts the CPU cycles of the calling thread (user space only), by
+  // perf_event_open. The cycles are converted to seconds by the average cycle
+  // frequency, as estimated by calibrate(). Falls back to chrono_timer for the
+  // whole run when calibrate() cannot open the counter, for example when
+  // perf_event_paranoid does not allow it, so that all samples have the same
+  // unit of ticks.
+  struct perf_event_timer
+  {
+    // The cycle counter of a thread. Its file descriptor is closed when the
+    // thread exits, as --threads=K starts new threads for each sample.
+    class thread_counter
+    {
+    public:
+      thread_counter()
+        :
+        m_file_descriptor{ open_file_descriptor() }
+      {
+      }
+
+      ~thread_counter()
+      {
+        close_file_descriptor();
+      }
+
+      thread_counter(const thread_counter&) = delete;
+      thread_counter& operator=(const thread_counter&) = delete;
+
+      bool is_open() const
+      {
+        return m_file_descriptor >= 0;
+      }
+
+      // Returns false when the counter is not open, or cannot be read. In the
+      // latter case, the counter is closed, so that the thread consistently
+      // uses the fallback from then on.
+      bool read_value(std::int64_t& value)
+      {
+        if ((m_file_descriptor >= 0) && (read(m_file_descriptor, &value, sizeof(value)) != sizeof(value)))
+        {
+          close_file_descriptor();
+        }
+        return m_file_descriptor >= 0;
+      }
+
+    private:
+      int m_file_descriptor;
+
+      // Returns -1, when the counter cannot be opened or read.
+      static int open_file_descriptor()
+      {
+        perf_event_attr attributes;
+        std::memset(&attributes, 0, sizeof(attributes));
+        attributes.type = PERF_TYPE_HARDWARE;
+        attributes.size = sizeof(attributes);
+        attributes.config = PERF_COUNT_HW_CPU_CYCLES;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+
+        int result = static_cast<int>(syscall(__NR_perf_event_open, &attributes, 0, -1, -1, 0));
+        std::int64_t value = 0;
+
+        if ((result >= 0) && (read(result, &value, sizeof(value)) != sizeof(value)))
+        {
+          close(result);
+          result = -1;
+        }
+        return result;
+      }
+
+      void close_file_descriptor()
+      {
+        if (m_file_descriptor >= 0)
+        {
+          close(m_file_descriptor);
+          m_file_descriptor = -1;
+        }
+      }
+    };
+
+    static thread_counter& get_thread_counter()
+    {
+      thread_local thread_counter counter;
+      return counter;
+    }
+
+    // Decided once for the whole run, by calibrate().
+    static bool is_available()
+    {
+      return get_timer_calibration<perf_event_timer>().is_counter_available;
+    }
+
+    // For a thread whose counter cannot be opened or read, although the
+    // counter of the thread of calibrate() could: the elapsed time of chrono_timer,
+    // converted to CPU cycles by the estimated cycle frequency, so that its
+    // ticks still have the same unit as those of the other threads.
+    static std::int64_t read_fallback_cycles()
+    {
+      static const bool is_warned = []
+      {
+        std::cerr << "Warning: perf_event_timer failed to open or read the CPU cycle counter of a thread,"
+          " so it uses chrono_timer for that thread instead!\n";
+        return true;
+      }();
+      static_cast<void>(is_warned);
+
+      return static_cast<std::int64_t>(static_cast<double>(chrono_timer::start()) *
+        chrono_timer::get_seconds_per_tick() / get_seconds_per_tick());
+    }
+
+    static std::int64_t start()
+    {
+      if (!is_available())
+      {
+        return chrono_timer::start();
+      }
+      std::int64_t result = 0;
+      return get_thread_counter().read_value(result) ? result : read_fallback_cycles();
+    }
+
+    static std::int64_t stop()
+    {
+      return start();
+    }
+
+    static double get_seconds_per_tick()
+    {
+      return get_timer_calibration<perf_event_timer>().seconds_per_tick;
+    }
+
+    static timer_calibration calibrate()
+    {
+      timer_calibration result;
+      result.is_counter_available = get_thread_counter().is_open();
+
+      if (result.is_counter_available)
+      {
+        // Estimated by reading the counter directly, as read_fallback_cycles()
+        // needs the result.
+        result.seconds_per_tick = estimate_seconds_per_tick([]
+          {
+            std::int64_t value = 0;
+            get_thread_counter().read_value(value);
+            return value;
+          });
+      }
+      else
+      {
+        std::cerr << "Warning: perf_event_open failed, so perf_event_timer uses chrono_timer instead!\n";
+        result.seconds_per_tick = chrono_timer::get_seconds_per_tick();
+      }
+      return result;
+    }
+  };
+#endif
+
+
+#ifndef NOEXCEPT_BENCHMARK_TIMER
+#  define NOEXCEPT_BENCHMARK_TIMER chrono_timer
+#endif
+
+  using default_timer = NOEXCEPT_BENCHMARK_TIMER;
+
+
+  // Returns the shortest duration (in seconds) between a start() and a stop()
+  // of the timer, with nothing in between.
+  template <typename Timer>
+  double measure_timer_overhead()
+  {
+    std::int64_t shortest = std::numeric_limits<std::int64_t>::max();
+
+    for (int i = 0; i < 10000; ++i)
+    {
+      const auto ticks1 = Timer::start();
+      const auto ticks2 = Timer::stop();
+      shortest = std::min(shortest, ticks2 - ticks1);
+    }
+    return static_cast<double>(shortest) * Timer::get_seconds_per_tick();
+  }
+
+
+  // Returns the smallest non-zero difference (in seconds) between two
+  // successive readings of the timer.
+  template <typename Timer>
+  double measure_timer_resolution()
+  {
+    std::int64_t smallest = std::numeric_limits<std::int64_t>::max();
+
+    for (int i = 0; i < 10000; ++i)
+    {
+      const auto ticks1 = Timer::stop();
+      auto ticks2 = Timer::stop();
+
+      while (ticks2 == ticks1)
+      {
+        ticks2 = Timer::stop();
+      }
+      smallest = std::min(smallest, ticks2 - ticks1);
+    }
+    return static_cast<double>(smallest) * Timer::get_seconds_per_tick();
+  }
+
+}
+
+#endif
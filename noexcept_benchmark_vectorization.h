@@ -0,0 +1,74 @@
+#ifndef noexcept_benchmark_vectorization_h
+#define noexcept_benchmark_vectorization_h
+
+/*
+Copyright Niels Dekker, LKEB, Leiden University Medical Center
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0.txt
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Whether the loop of a simd test case is vectorized by the compiler, as
+// reported at build time. For each lib/simd_*_test.cpp, GCC writes its
+// report (-fopt-info-vec-optimized-missed) next to each lib file, for
+// example, "libnoexcept_lib.so.simd_transform_float_test.vectorization.txt".
+// Unknown for other compilers, and for the other test cases.
+
+#include <fstream>
+#include <string>
+
+
+namespace noexcept_benchmark
+{
+  enum class loop_vectorization
+  {
+    unknown,
+    not_vectorized,
+    vectorized
+  };
+
+
+  inline const char* to_string(const loop_vectorization vectorization)
+  {
+    return (vectorization == loop_vectorization::vectorized) ? "vectorized" :
+      (vectorization == loop_vectorization::not_vectorized) ? "not vectorized" : "unknown";
+  }
+
+
+  // Reads the vectorization report of the test case (whose id should not have
+  // a lib variant suffix, like "/O2") for the specified lib file. Only looks
+  // at the lines about its own source file, <id>_test.cpp, as the report also
+  // has the loops of the headers that it includes.
+  inline loop_vectorization get_loop_vectorization(const std::string& lib_file_name, const std::string& test_case_id)
+  {
+    std::ifstream report(lib_file_name + '.' + test_case_id + "_test.vectorization.txt");
+    const std::string source_location = test_case_id + "_test.cpp:";
+    loop_vectorization result = loop_vectorization::unknown;
+    std::string line;
+
+    while (std::getline(report, line))
+    {
+      if (line.find(source_location) != std::string::npos)
+      {
+        if (line.find("optimized: loop vectorized") != std::string::npos)
+        {
+          return loop_vectorization::vectorized;
+        }
+        result = loop_vectorization::not_vectorized;
+      }
+    }
+    return result;
+  }
+
+}
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef noexcept_benchmark_static_lib_h
+#define noexcept_benchmark_static_lib_h
+
+/*
+Copyright Niels Dekker, LKEB, Leiden University Medical Center
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0.txt
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Static libraries, linked into the executable, to benchmark function calls
+// that do not cross a shared library boundary: noexcept_static_lib and
+// implicit_static_lib, and their variants that are built with IPO (LTO),
+// noexcept_ipo_lib and implicit_ipo_lib, whose calls may be inlined across
+// translation units. The called function is defined in static_lib_func.cpp,
+// while the test functions that call it are in static_lib_call_test.cpp.
+
+// The static libs, as X(lib, description). The ipo_lib is only built when
+// CMake supports IPO for the compiler.
+#if NOEXCEPT_BENCHMARK_HAS_IPO_LIB
+#  define NOEXCEPT_BENCHMARK_STATIC_LIBS(X) \
+  X(static_lib, "static library") \
+  X(ipo_lib, "static library built with IPO/LTO")
+#else
+#  define NOEXCEPT_BENCHMARK_STATIC_LIBS(X) \
+  X(static_lib, "static library")
+#endif
+
+#define NOEXCEPT_BENCHMARK_DECLARE_STATIC_LIB(lib_name, exception_specifier) \
+  namespace lib_name \
+  { \
+    void static_lib_func(bool do_throw_exception) exception_specifier; \
+    \
+    struct func_interface \
+    { \
+      virtual void func(bool do_throw_exception) exception_specifier = 0; \
+    protected: \
+      ~func_interface() = default; \
+    }; \
+    \
+    /* Return static_lib_func, and an object whose func calls static_lib_func. */ \
+    void (*get_func_pointer())(bool) exception_specifier; \
+    func_interface& get_func_object(); \
+    \
+    double test_call(unsigned N); \
+    double test_func_pointer_call(unsigned N); \
+    double test_virtual_call(unsigned N); \
+  }
+
+NOEXCEPT_BENCHMARK_DECLARE_STATIC_LIB(noexcept_static_lib, noexcept)
+NOEXCEPT_BENCHMARK_DECLARE_STATIC_LIB(implicit_static_lib, )
+NOEXCEPT_BENCHMARK_DECLARE_STATIC_LIB(noexcept_ipo_lib, noexcept)
+NOEXCEPT_BENCHMARK_DECLARE_STATIC_LIB(implicit_ipo_lib, )
+
+#undef NOEXCEPT_BENCHMARK_DECLARE_STATIC_LIB
+
+#endif
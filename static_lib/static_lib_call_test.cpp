@@ -0,0 +1,67 @@
+/*
+Copyright Niels Dekker, LKEB, Leiden University Medical Center
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0.txt
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "noexcept_benchmark.h"
+#include "static_lib/static_lib.h"
+
+namespace STATIC_LIB_NAME = NOEXCEPT_BENCHMARK_STATIC_LIB_NAME;
+
+
+double STATIC_LIB_NAME::test_call(const unsigned N)
+{
+  return noexcept_benchmark::profile_func_call([N]
+  {
+    bool do_throw_exception = false;
+
+    for (unsigned i = 0; i < N; ++i)
+    {
+      noexcept_benchmark::do_not_optimize(do_throw_exception);
+      static_lib_func(do_throw_exception);
+    }
+  });
+}
+
+
+double STATIC_LIB_NAME::test_func_pointer_call(const unsigned N)
+{
+  return noexcept_benchmark::profile_func_call([N]
+  {
+    bool do_throw_exception = false;
+    const auto func_pointer = get_func_pointer();
+
+    for (unsigned i = 0; i < N; ++i)
+    {
+      noexcept_benchmark::do_not_optimize(do_throw_exception);
+      func_pointer(do_throw_exception);
+    }
+  });
+}
+
+
+double STATIC_LIB_NAME::test_virtual_call(const unsigned N)
+{
+  return noexcept_benchmark::profile_func_call([N]
+  {
+    bool do_throw_exception = false;
+    func_interface& func_object = get_func_object();
+
+    for (unsigned i = 0; i < N; ++i)
+    {
+      noexcept_benchmark::do_not_optimize(do_throw_exception);
+      func_object.func(do_throw_exception);
+    }
+  });
+}
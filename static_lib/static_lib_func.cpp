@@ -0,0 +1,51 @@
+/*
+Copyright Niels Dekker, LKEB, Leiden University Medical Center
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0.txt
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "noexcept_benchmark.h"
+#include "static_lib/static_lib.h"
+
+namespace STATIC_LIB_NAME = NOEXCEPT_BENCHMARK_STATIC_LIB_NAME;
+
+namespace
+{
+  class func_object : public STATIC_LIB_NAME::func_interface
+  {
+  public:
+    void func(const bool do_throw_exception) OPTIONAL_EXCEPTION_SPECIFIER override
+    {
+      STATIC_LIB_NAME::static_lib_func(do_throw_exception);
+    }
+  };
+}
+
+
+void STATIC_LIB_NAME::static_lib_func(const bool do_throw_exception) OPTIONAL_EXCEPTION_SPECIFIER
+{
+  noexcept_benchmark::throw_exception_if(do_throw_exception);
+}
+
+
+void (*STATIC_LIB_NAME::get_func_pointer())(bool) OPTIONAL_EXCEPTION_SPECIFIER
+{
+  return static_lib_func;
+}
+
+
+STATIC_LIB_NAME::func_interface& STATIC_LIB_NAME::get_func_object()
+{
+  static func_object object;
+  return object;
+}